@@ -0,0 +1,21 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform CameraUniform {
+    mat4 viewProjection;
+} camera;
+
+// Written by the culling pass, indexed by the firstInstance of each draw
+layout(std430, binding = 1) readonly buffer VisibleModels {
+    mat4 visibleModels[];
+};
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = camera.viewProjection * visibleModels[gl_InstanceIndex] * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor;
+}
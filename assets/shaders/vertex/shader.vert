@@ -1,9 +1,13 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject {
-    mat4 mvp;
-} ubo;
+layout(binding = 0) uniform CameraUniform {
+    mat4 viewProjection;
+} camera;
+
+layout(push_constant) uniform MeshPushConstants {
+    mat4 model;
+} mesh;
 
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -11,6 +15,6 @@ layout(location = 1) in vec3 inColor;
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = ubo.mvp * vec4(inPosition, 0.0, 1.0);
+    gl_Position = camera.viewProjection * mesh.model * vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
 }
\ No newline at end of file
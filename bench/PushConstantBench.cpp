@@ -0,0 +1,346 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "volk.h"
+
+#include "glm/glm.hpp"
+
+// Usage: PushConstantBench [draws per frame] [frames]
+// Records the per-draw transform updates of the mesh render manager before
+// and after push constants into one command buffer on a headless device and
+// reports the CPU time per draw. The draw call itself is the same in both
+// paths and needs a pipeline, so it is left out of both.
+
+struct BenchContext {
+  VkInstance instance = VK_NULL_HANDLE;
+  VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+  VkDevice device = VK_NULL_HANDLE;
+  uint32_t queueFamily = 0;
+  VkCommandPool commandPool = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+};
+
+static bool createContext(BenchContext &context) {
+  if (volkInitialize() != VK_SUCCESS) {
+    std::cerr << "no vulkan loader found" << std::endl;
+    return false;
+  }
+
+  VkApplicationInfo appInfo = {};
+  appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+  appInfo.pApplicationName = "PushConstantBench";
+  appInfo.apiVersion = VK_API_VERSION_1_0;
+
+  VkInstanceCreateInfo instanceInfo = {};
+  instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+  instanceInfo.pApplicationInfo = &appInfo;
+
+  if (vkCreateInstance(&instanceInfo, nullptr, &context.instance) !=
+      VK_SUCCESS) {
+    std::cerr << "failed to create vulkan instance" << std::endl;
+    return false;
+  }
+  volkLoadInstance(context.instance);
+
+  uint32_t deviceCount = 0;
+  vkEnumeratePhysicalDevices(context.instance, &deviceCount, nullptr);
+  std::vector<VkPhysicalDevice> devices(deviceCount);
+  vkEnumeratePhysicalDevices(context.instance, &deviceCount, devices.data());
+
+  for (int i = 0; i < devices.size() && !context.physicalDevice; i++) {
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount,
+                                             nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount,
+                                             families.data());
+
+    for (uint32_t family = 0; family < familyCount; family++) {
+      if (families[family].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        context.physicalDevice = devices[i];
+        context.queueFamily = family;
+        break;
+      }
+    }
+  }
+
+  if (context.physicalDevice == VK_NULL_HANDLE) {
+    std::cerr << "no vulkan device with a graphics queue" << std::endl;
+    return false;
+  }
+
+  float priority = 1.0f;
+  VkDeviceQueueCreateInfo queueInfo = {};
+  queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+  queueInfo.queueFamilyIndex = context.queueFamily;
+  queueInfo.queueCount = 1;
+  queueInfo.pQueuePriorities = &priority;
+
+  VkDeviceCreateInfo deviceInfo = {};
+  deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  deviceInfo.queueCreateInfoCount = 1;
+  deviceInfo.pQueueCreateInfos = &queueInfo;
+
+  if (vkCreateDevice(context.physicalDevice, &deviceInfo, nullptr,
+                     &context.device) != VK_SUCCESS) {
+    std::cerr << "failed to create vulkan device" << std::endl;
+    return false;
+  }
+  volkLoadDevice(context.device);
+
+  VkCommandPoolCreateInfo poolInfo = {};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = context.queueFamily;
+  vkCreateCommandPool(context.device, &poolInfo, nullptr,
+                      &context.commandPool);
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = context.commandPool;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  vkAllocateCommandBuffers(context.device, &allocInfo,
+                           &context.commandBuffer);
+  return true;
+}
+
+static void destroyContext(BenchContext &context) {
+  if (context.device != VK_NULL_HANDLE) {
+    vkDestroyCommandPool(context.device, context.commandPool, nullptr);
+    vkDestroyDevice(context.device, nullptr);
+  }
+  if (context.instance != VK_NULL_HANDLE) {
+    vkDestroyInstance(context.instance, nullptr);
+  }
+}
+
+static uint32_t findHostVisibleMemory(VkPhysicalDevice physicalDevice,
+                                      uint32_t typeBits) {
+  VkPhysicalDeviceMemoryProperties properties;
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties);
+
+  VkMemoryPropertyFlags wanted = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+    if ((typeBits & (1 << i)) &&
+        (properties.memoryTypes[i].propertyFlags & wanted) == wanted) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+static VkDescriptorSetLayout createSetLayout(VkDevice device,
+                                             VkDescriptorType type) {
+  VkDescriptorSetLayoutBinding binding = {};
+  binding.binding = 0;
+  binding.descriptorType = type;
+  binding.descriptorCount = 1;
+  binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = 1;
+  layoutInfo.pBindings = &binding;
+
+  VkDescriptorSetLayout setLayout;
+  vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout);
+  return setLayout;
+}
+
+static VkPipelineLayout createPipelineLayout(VkDevice device,
+                                             VkDescriptorSetLayout setLayout,
+                                             bool pushConstants) {
+  VkPushConstantRange range = {};
+  range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  range.size = sizeof(glm::mat4);
+
+  VkPipelineLayoutCreateInfo layoutInfo = {};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  layoutInfo.setLayoutCount = 1;
+  layoutInfo.pSetLayouts = &setLayout;
+  layoutInfo.pushConstantRangeCount = pushConstants ? 1 : 0;
+  layoutInfo.pPushConstantRanges = &range;
+
+  VkPipelineLayout pipelineLayout;
+  vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout);
+  return pipelineLayout;
+}
+
+static double elapsedNanoseconds(
+    std::chrono::high_resolution_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::high_resolution_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  uint32_t drawCount = argc > 1 ? std::stoul(argv[1]) : 10000;
+  uint32_t frameCount = argc > 2 ? std::stoul(argv[2]) : 100;
+
+  BenchContext context;
+  if (!createContext(context)) {
+    destroyContext(context);
+    return 1;
+  }
+  VkDevice device = context.device;
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+  VkDeviceSize alignment =
+      properties.limits.minUniformBufferOffsetAlignment;
+  VkDeviceSize stride =
+      (sizeof(glm::mat4) + alignment - 1) / alignment * alignment;
+
+  // Before: one MVP per draw in a mapped dynamic uniform buffer
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = stride * drawCount;
+  bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  VkBuffer uniformBuffer;
+  vkCreateBuffer(device, &bufferInfo, nullptr, &uniformBuffer);
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements(device, uniformBuffer, &requirements);
+
+  VkMemoryAllocateInfo memoryInfo = {};
+  memoryInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  memoryInfo.allocationSize = requirements.size;
+  memoryInfo.memoryTypeIndex = findHostVisibleMemory(
+      context.physicalDevice, requirements.memoryTypeBits);
+
+  VkDeviceMemory uniformMemory;
+  vkAllocateMemory(device, &memoryInfo, nullptr, &uniformMemory);
+  vkBindBufferMemory(device, uniformBuffer, uniformMemory, 0);
+
+  char *mapped;
+  vkMapMemory(device, uniformMemory, 0, VK_WHOLE_SIZE, 0,
+              reinterpret_cast<void **>(&mapped));
+
+  VkDescriptorSetLayout dynamicSetLayout =
+      createSetLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+  VkDescriptorSetLayout cameraSetLayout =
+      createSetLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+  VkPipelineLayout dynamicLayout =
+      createPipelineLayout(device, dynamicSetLayout, false);
+  VkPipelineLayout pushLayout =
+      createPipelineLayout(device, cameraSetLayout, true);
+
+  VkDescriptorPoolSize poolSizes[2] = {};
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  poolSizes[0].descriptorCount = 1;
+  poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  poolSizes[1].descriptorCount = 1;
+
+  VkDescriptorPoolCreateInfo poolInfo = {};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.poolSizeCount = 2;
+  poolInfo.pPoolSizes = poolSizes;
+  poolInfo.maxSets = 2;
+
+  VkDescriptorPool descriptorPool;
+  vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool);
+
+  VkDescriptorSetLayout setLayouts[] = {dynamicSetLayout, cameraSetLayout};
+  VkDescriptorSetAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = descriptorPool;
+  allocInfo.descriptorSetCount = 2;
+  allocInfo.pSetLayouts = setLayouts;
+
+  VkDescriptorSet sets[2];
+  vkAllocateDescriptorSets(device, &allocInfo, sets);
+
+  VkDescriptorBufferInfo descriptorInfos[2] = {};
+  descriptorInfos[0].buffer = uniformBuffer;
+  descriptorInfos[0].range = sizeof(glm::mat4);
+  descriptorInfos[1].buffer = uniformBuffer;
+  descriptorInfos[1].range = sizeof(glm::mat4);
+
+  VkWriteDescriptorSet writes[2] = {};
+  for (int i = 0; i < 2; i++) {
+    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet = sets[i];
+    writes[i].descriptorCount = 1;
+    writes[i].descriptorType = i == 0
+                                   ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+                                   : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[i].pBufferInfo = &descriptorInfos[i];
+  }
+  vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+
+  std::vector<glm::mat4> models(drawCount);
+  for (uint32_t i = 0; i < drawCount; i++) {
+    models[i] = glm::mat4(1.0f);
+    models[i][3] = glm::vec4(static_cast<float>(i), 0.0f, 0.0f, 1.0f);
+  }
+  glm::mat4 viewProjection(1.0f);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  double dynamicTime = 0.0;
+  double pushTime = 0.0;
+
+  // The first frame of each path warms up driver allocations and is not timed
+  for (uint32_t frame = 0; frame <= frameCount; frame++) {
+    vkResetCommandBuffer(context.commandBuffer, 0);
+    vkBeginCommandBuffer(context.commandBuffer, &beginInfo);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < drawCount; i++) {
+      glm::mat4 mvp = viewProjection * models[i];
+      uint32_t offset = static_cast<uint32_t>(stride * i);
+      memcpy(mapped + offset, &mvp, sizeof(glm::mat4));
+      vkCmdBindDescriptorSets(context.commandBuffer,
+                              VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicLayout,
+                              0, 1, &sets[0], 1, &offset);
+    }
+    if (frame > 0) {
+      dynamicTime += elapsedNanoseconds(start);
+    }
+    vkEndCommandBuffer(context.commandBuffer);
+
+    vkResetCommandBuffer(context.commandBuffer, 0);
+    vkBeginCommandBuffer(context.commandBuffer, &beginInfo);
+    start = std::chrono::high_resolution_clock::now();
+    memcpy(mapped, &viewProjection, sizeof(glm::mat4));
+    vkCmdBindDescriptorSets(context.commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS, pushLayout, 0, 1,
+                            &sets[1], 0, nullptr);
+    for (uint32_t i = 0; i < drawCount; i++) {
+      vkCmdPushConstants(context.commandBuffer, pushLayout,
+                         VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4),
+                         &models[i]);
+    }
+    if (frame > 0) {
+      pushTime += elapsedNanoseconds(start);
+    }
+    vkEndCommandBuffer(context.commandBuffer);
+  }
+
+  double draws = static_cast<double>(drawCount) * frameCount;
+  std::cout << properties.deviceName << ", " << drawCount << " draws x "
+            << frameCount << " frames" << std::endl;
+  std::cout << "dynamic uniform + descriptor bind: " << dynamicTime / draws
+            << " ns/draw" << std::endl;
+  std::cout << "push constants:                    " << pushTime / draws
+            << " ns/draw" << std::endl;
+
+  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+  vkDestroyPipelineLayout(device, dynamicLayout, nullptr);
+  vkDestroyPipelineLayout(device, pushLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, dynamicSetLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, cameraSetLayout, nullptr);
+  vkUnmapMemory(device, uniformMemory);
+  vkDestroyBuffer(device, uniformBuffer, nullptr);
+  vkFreeMemory(device, uniformMemory, nullptr);
+  destroyContext(context);
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Engine/Resources/ResourceId.h"
+#include "Engine/Resources/ResourcePool.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+
+// Usage: ResourceLookupBench [resources] [lookups]
+// Compares the cost of one resource lookup through the old string keyed map,
+// the hashed resource id map and a resource handle. Each path mirrors what
+// ResourceManager does per call, locking included.
+
+struct BenchResource {
+  uint32_t value;
+};
+
+struct BenchEntry {
+  std::shared_ptr<BenchResource> resource;
+  std::string path;
+};
+
+static double elapsedNanoseconds(
+    std::chrono::high_resolution_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::high_resolution_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  uint32_t resourceCount = argc > 1 ? std::stoul(argv[1]) : 1000;
+  uint32_t lookupCount = argc > 2 ? std::stoul(argv[2]) : 10000000;
+
+  std::vector<std::string> paths(resourceCount);
+  std::vector<ResourceId> ids;
+  std::vector<ResourceHandle<BenchResource>> handles(resourceCount);
+
+  std::unordered_map<std::string, std::shared_ptr<BenchResource>> stringMap;
+  FlatHashMap<BenchEntry> hashMap;
+  ResourcePool<BenchResource> pool;
+  std::mutex mutex;
+
+  for (uint32_t i = 0; i < resourceCount; i++) {
+    paths[i] = "assets/meshes/mesh_" + std::to_string(i) + ".json";
+  }
+  for (uint32_t i = 0; i < resourceCount; i++) {
+    // String literals hash at compile time, precomputed here instead
+    ids.push_back(ResourceId(hashPath(paths[i]), paths[i].c_str()));
+
+    std::shared_ptr<BenchResource> resource(new BenchResource{i});
+    stringMap[paths[i]] = resource;
+
+    BenchEntry &entry = hashMap.insert(ids[i].hash);
+    entry.resource = resource;
+    entry.path = paths[i];
+
+    handles[i] = pool.retain(pool.insert(resource, ids[i].hash));
+  }
+
+  uint64_t checksum = 0;
+
+  // Old: a std::string built from the literal at every call site, then a
+  // find and a second lookup to fetch the value
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < lookupCount; i++) {
+    const char *path = paths[i % resourceCount].c_str();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key(path);
+    if (stringMap.find(key) != stringMap.end()) {
+      checksum += stringMap[key]->value;
+    }
+  }
+  double stringTime = elapsedNanoseconds(start);
+
+  // Hashed id: one probe into the flat map and a path compare on the hit
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < lookupCount; i++) {
+    const ResourceId &id = ids[i % resourceCount];
+    std::lock_guard<std::mutex> lock(mutex);
+    BenchEntry *entry = hashMap.find(id.hash);
+    if (entry != nullptr && entry->path == id.path) {
+      checksum += entry->resource->value;
+    }
+  }
+  double hashTime = elapsedNanoseconds(start);
+
+  // Handle: an array index and a generation compare, without locking
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < lookupCount; i++) {
+    BenchResource *resource = pool.get(handles[i % resourceCount]);
+    if (resource != nullptr) {
+      checksum += resource->value;
+    }
+  }
+  double handleTime = elapsedNanoseconds(start);
+
+  std::cout << resourceCount << " resources, " << lookupCount
+            << " lookups (checksum " << checksum << ")" << std::endl;
+  std::cout << "string map:      " << stringTime / lookupCount << " ns/lookup"
+            << std::endl;
+  std::cout << "hashed id map:   " << hashTime / lookupCount << " ns/lookup"
+            << std::endl;
+  std::cout << "resource handle: " << handleTime / lookupCount << " ns/lookup"
+            << std::endl;
+  return 0;
+}
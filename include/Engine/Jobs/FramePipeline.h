@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "Engine/Scene/RenderSnapshot.h"
+
+// Runs simulation on its own thread up to depth - 1 frames ahead of rendering,
+// each stage owning a different snapshot slot at any time
+class FramePipeline {
+private:
+  std::vector<RenderSnapshot> snapshots;
+  std::function<void(RenderSnapshot &)> simulate;
+
+  uint64_t simulatedFrames = 0;
+  uint64_t renderedFrames = 0;
+  bool running = true;
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread simulationThread;
+
+  void simulationLoop();
+
+public:
+  FramePipeline(uint32_t depth, std::function<void(RenderSnapshot &)> simulate);
+  ~FramePipeline();
+
+  // Blocks until the oldest simulated snapshot is ready, renders it and hands
+  // its slot back to the simulation thread
+  void renderFrame(const std::function<void(const RenderSnapshot &)> &render);
+};
\ No newline at end of file
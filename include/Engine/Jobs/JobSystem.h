@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+class JobCounter;
+
+struct Job {
+  std::function<void()> function;
+  JobCounter *counter = nullptr;
+};
+
+// Number of outstanding jobs. Jobs depending on a counter are parked on it
+// and queued once it reaches zero, so they never sit in a queue unrunnable.
+class JobCounter {
+private:
+  std::atomic<uint32_t> value;
+  // Guards dependents and the decrement to zero, which hands them over
+  std::mutex mutex;
+  std::vector<Job> dependents;
+
+  friend class JobSystem;
+
+public:
+  JobCounter(uint32_t value = 0) : value(value) {}
+
+  uint32_t get() const { return value; }
+};
+
+// Jobs one queue holds, pushes past it go to other queues or run inline
+const uint32_t JOB_QUEUE_CAPACITY = 1024;
+
+// Fixed ring of jobs, allocated once so queueing never touches the heap
+class JobQueue {
+private:
+  std::mutex mutex;
+  std::vector<Job> jobs;
+  // Oldest job, the next free slot is count positions after it
+  uint32_t head = 0;
+  uint32_t count = 0;
+
+public:
+  JobQueue();
+
+  // Leaves the job untouched and returns false when the queue is full
+  bool push(Job &job);
+  // Owner side, LIFO for cache locality
+  bool pop(Job &job);
+  // Thief side, FIFO so the oldest and usually largest work moves
+  bool steal(Job &job);
+};
+
+class JobSystem {
+private:
+  static JobSystem *instance;
+
+  std::vector<std::thread> workers;
+  std::vector<JobQueue *> queues;
+
+  std::atomic<bool> running{true};
+  std::atomic<uint32_t> queuedJobs{0};
+  std::atomic<uint32_t> nextQueue{0};
+
+  std::mutex sleepMutex;
+  std::condition_variable sleepCondition;
+
+  void workerLoop(uint32_t workerIndex);
+  bool findJob(uint32_t queueIndex, Job &job);
+  // False when every queue is full, the caller runs the job itself
+  bool push(Job &job);
+  void execute(Job &job);
+  // Counts a job of the counter as done, queueing its dependents on zero
+  void complete(JobCounter *counter);
+
+public:
+  JobSystem(uint32_t workerCount);
+  ~JobSystem();
+
+  // Queues the job, or parks it on dependency until that reaches zero
+  void run(std::function<void()> function, JobCounter *counter,
+           JobCounter *dependency = nullptr);
+
+  // Splits [0, count) into ranges of at most grainSize and blocks until every
+  // range has run, the calling thread helps out while it waits
+  void parallelFor(uint32_t count, uint32_t grainSize,
+                   const std::function<void(uint32_t, uint32_t)> &function);
+
+  // Runs queued jobs until the counter reaches zero, sleeping while there
+  // are none
+  void wait(JobCounter *counter);
+
+  uint32_t getWorkerCount();
+
+  static JobSystem *getInstance();
+};
\ No newline at end of file
@@ -9,6 +9,5 @@ struct RendererParams {
 class Renderer {
 public:
   virtual void init(const RendererParams &params) = 0;
-  virtual void beginFrame() = 0;
   virtual void endFrame() = 0;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanShaderReflection.h"
+#include "Engine/Resources/Resource.h"
+
+// A compute shader and the pipeline built from it. Layouts come from the
+// shader's reflected interface through the device's layout cache, so sets
+// allocated against one load stay valid for a reload with the same bindings.
+class VulkanComputePipelineResource : public Resource {
+private:
+  VulkanDevice *device;
+
+  VkShaderModule shaderModule = VK_NULL_HANDLE;
+  VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+
+  std::vector<VkDescriptorSetLayout> descriptorLayouts;
+  VkPushConstantRange pushConstantRange = {};
+
+  void createLayouts(const ShaderReflection &reflection);
+
+public:
+  VulkanComputePipelineResource(VulkanDevice *device,
+                                const std::vector<char> &computeCode) {
+    this->device = device;
+    load(computeCode);
+  };
+
+  ~VulkanComputePipelineResource();
+
+  void load(const std::vector<char> &computeCode);
+
+  VkPipeline getPipeline();
+  VkPipelineLayout getPipelineLayout();
+  VkDescriptorSetLayout getDescriptorSetLayout(uint32_t set = 0);
+  VkPushConstantRange getPushConstantRange();
+};
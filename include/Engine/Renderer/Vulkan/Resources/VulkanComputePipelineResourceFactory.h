@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanComputePipelineResource.h"
+#include "Engine/Resources/ResourceFactory.h"
+#include "Engine/Resources/ResourceManager.h"
+
+class VulkanComputePipelineResourceFactory : public ResourceFactory {
+private:
+  VulkanDevice *device;
+
+public:
+  VulkanComputePipelineResourceFactory(VulkanDevice *device) {
+    this->device = device;
+    this->resourceType = "vulkan_compute_pipeline";
+  }
+
+  // Only creates device objects, like graphics pipelines
+  bool supportsReload() { return true; }
+
+  std::shared_ptr<Resource> load(const std::string &path) {
+    std::vector<char> buffer;
+    ResourceManager::getInstance()->readFile(path, buffer);
+
+    rapidjson::Document document;
+    document.Parse(buffer.data(), buffer.size());
+
+    if (document.HasParseError() || !document.HasMember("compute_code") ||
+        !document["compute_code"].IsString()) {
+      spdlog::error("invalid compute pipeline {0}", path);
+      return nullptr;
+    }
+
+    spdlog::debug("Comp: {0}", document["compute_code"].GetString());
+
+    std::vector<char> computeCode;
+    ResourceManager::getInstance()->readFile(
+        document["compute_code"].GetString(), computeCode);
+
+    std::shared_ptr<VulkanComputePipelineResource> ptr(
+        new VulkanComputePipelineResource(device, computeCode));
+    ptr->setResourceType(RESOURCE_VULKAN_COMPUTE_PIPELINE);
+    return std::static_pointer_cast<Resource>(ptr);
+  }
+};
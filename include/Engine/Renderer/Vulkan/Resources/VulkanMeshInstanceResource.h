@@ -2,6 +2,7 @@
 
 #include "Engine/Renderer/Vulkan/VulkanBuffer.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshResource.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanTextureResource.h"
 #include "Engine/Resources/Resource.h"
 #include "glm/glm.hpp"
 
@@ -18,11 +19,14 @@ private:
   UniformBufferObject ubo;
 
   std::shared_ptr<VulkanMeshResource> mesh;
+  std::shared_ptr<VulkanTextureResource> texture;
 public:
-  VulkanMeshInstanceResource(VulkanDevice* device, int descriptorIndex, std::shared_ptr<VulkanMeshResource> mesh);
+  VulkanMeshInstanceResource(VulkanDevice* device, int descriptorIndex, std::shared_ptr<VulkanMeshResource> mesh, std::shared_ptr<VulkanTextureResource> texture);
   ~VulkanMeshInstanceResource();
 
-  std::shared_ptr<VulkanMeshResource> getMesh();
+  VulkanMeshResource *getMesh();
+  // Null for untextured instances
+  VulkanTextureResource *getTexture();
 
   void update(UniformBufferObject ubo);
 
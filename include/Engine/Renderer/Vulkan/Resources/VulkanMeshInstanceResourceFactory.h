@@ -3,8 +3,11 @@
 #include "Engine/Resources/ResourceFactory.h"
 #include "Engine/Resources/ResourceManager.h"
 
+#include "document.h"
+
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshResource.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshInstanceResource.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanResourceIds.h"
 
 
 class VulkanMeshInstanceResourceFactory : public ResourceFactory {
@@ -18,9 +21,22 @@ public:
   }
 
   std::shared_ptr<Resource> load(const std::string &path) {
-    std::shared_ptr<Resource> mesh = ResourceManager::getInstance()->getResource("assets/meshes/test_vk_mesh.json");
-    std::shared_ptr<VulkanMeshResource> meshResource = std::static_pointer_cast<VulkanMeshResource>(mesh);
-    std::shared_ptr<VulkanMeshInstanceResource> ptr(new VulkanMeshInstanceResource(device, currentId, meshResource));
+    std::shared_ptr<VulkanMeshResource> meshResource = ResourceManager::getInstance()->getResource(TEST_MESH_RESOURCE);
+
+    std::vector<char> buffer;
+    ResourceManager::getInstance()->readFile(path, buffer);
+
+    rapidjson::Document document;
+    document.Parse(buffer.data(), buffer.size());
+
+    std::shared_ptr<VulkanTextureResource> textureResource;
+    if (document.IsObject() && document.HasMember("texture") &&
+        document["texture"].IsString()) {
+      textureResource = std::static_pointer_cast<VulkanTextureResource>(
+          ResourceManager::getInstance()->getResource(std::string(document["texture"].GetString())));
+    }
+
+    std::shared_ptr<VulkanMeshInstanceResource> ptr(new VulkanMeshInstanceResource(device, currentId, meshResource, textureResource));
     ptr->setResourceType(RESOURCE_VULKAN_MESH_INSTANCE);
 
     currentId++;
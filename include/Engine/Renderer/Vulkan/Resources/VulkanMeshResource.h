@@ -22,7 +22,11 @@ private:
   VulkanBuffer *vertexBuffer;
   VulkanBuffer *indexBuffer;
 
+  // Bounding sphere in model space, xyz center and w radius
+  glm::vec4 bounds;
+
   void loadBuffers();
+  void computeBounds();
 
 public:
   VulkanMeshResource(VulkanDevice *device);
@@ -32,4 +36,5 @@ public:
   VkBuffer getIndexBuffer();
 
   int getIndexCount();
+  glm::vec4 getBounds();
 };
@@ -6,33 +6,78 @@
 #include "spdlog/spdlog.h"
 #include "volk.h"
 
+#include <mutex>
+#include <string>
+
+#include "Engine/Jobs/JobSystem.h"
 #include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanPipelineState.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+#include "Engine/Renderer/Vulkan/VulkanShaderReflection.h"
 #include "Engine/Renderer/Vulkan/VulkanVertex.h"
 
+#include "glm/glm.hpp"
+
+// Per-frame data bound once through descriptor set 0, binding 0
+struct CameraUniform {
+  glm::mat4 viewProjection;
+};
+
+// Per-draw data pushed with vkCmdPushConstants, kept within the 128 byte
+// minimum guaranteed by maxPushConstantsSize
+struct MeshPushConstants {
+  glm::mat4 model;
+};
+
 class VulkanPipelineResource : public Resource {
 private:
   VkShaderModule createShaderModule(const std::vector<char> &code);
 
-  void createDescriptorSetLayout();
+  // Layouts come from the shaders' reflected interface and are shared through
+  // the device's layout cache with every pipeline of the same signature
+  bool createLayouts(const std::vector<char> &vertexCode,
+                     const std::vector<char> &fragmentCode);
+  void checkVertexInputs(const ShaderReflection &reflection);
+
+  VkPipeline createVariant(const PipelineState &state,
+                           const RenderPassKey &renderPassKey);
+  uint64_t getVariantKey(const PipelineState &state,
+                         const RenderPassKey &renderPassKey);
+  // Builds the variants this pipeline needed in previous runs
+  void prewarmVariants();
 
   VulkanDevice *device;
   RendererParams params;
+  std::string sourcePath;
   std::vector<VkShaderModule> createdModules;
 
-  VkRenderPass renderPass;
-  VkPipelineLayout pipelineLayout;
-  VkPipeline graphicsPipeline;
+  // Render pass compatibility of the variant built at load time
+  RenderPassKey renderPassKey;
+  VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+  VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+
+  // Every variant built so far, keyed by state, render pass compatibility and
+  // vertex layout, the shader set being this resource itself
+  FlatHashMap<VkPipeline> variants;
+  // Variants being built in the background by requestPipeline
+  FlatHashMap<bool> pendingVariants;
+  JobCounter pendingBuilds{0};
+  std::mutex variantMutex;
+  uint64_t vertexLayoutHash = 0;
 
-  VkDescriptorSetLayout descriptorLayout;
+  std::vector<VkDescriptorSetLayout> descriptorLayouts;
+  VkPushConstantRange pushConstantRange = {};
 
 public:
   VulkanPipelineResource(VulkanDevice *device, RendererParams params,
-                         VkRenderPass renderPass,
+                         RenderPassKey renderPassKey,
+                         const std::string &sourcePath,
                          const std::vector<char> &vertexCode,
                          const std::vector<char> &fragmentCode) {
     this->params = params;
     this->device = device;
-    this->renderPass = renderPass;
+    this->renderPassKey = renderPassKey;
+    this->sourcePath = sourcePath;
     load(vertexCode, fragmentCode);
   };
 
@@ -41,7 +86,17 @@ public:
   void load(const std::vector<char> &vertexCode,
             const std::vector<char> &fragmentCode);
 
+  // The default state variant for the render pass the pipeline was loaded for
   VkPipeline getPipeline();
+  // Builds and memoises the variant on first use, safe from any thread. The
+  // pipeline works with every render pass compatible with the key.
+  VkPipeline getPipeline(const PipelineState &state,
+                         const RenderPassKey &renderPassKey);
+  // Same as getPipeline but never blocks the caller, a missing variant is
+  // built on the job system and VK_NULL_HANDLE returned until it is ready
+  VkPipeline requestPipeline(const PipelineState &state,
+                             const RenderPassKey &renderPassKey);
   VkPipelineLayout getPipelineLayout();
-  VkDescriptorSetLayout getDescriptorSetLayout();
+  VkDescriptorSetLayout getDescriptorSetLayout(uint32_t set = 0);
+  VkPushConstantRange getPushConstantRange();
 };
\ No newline at end of file
@@ -4,46 +4,41 @@
 
 #include "Engine/Renderer/Vulkan/Resources/VulkanPipelineResource.h"
 #include "Engine/Resources/ResourceFactory.h"
+#include "Engine/Resources/ResourceManager.h"
 
 class VulkanPipelineResourceFactory : public ResourceFactory {
 private:
   VulkanDevice *device;
-  VkRenderPass renderPass;
+  // Render pass compatibility pipelines build their default variant for,
+  // other passes get their variants on first use
+  RenderPassKey renderPassKey;
   RendererParams params;
 
   std::vector<char> readSpirv(const std::string &path) {
-    SDL_RWops *sdlFile = SDL_RWFromFile(path.c_str(), "rb");
-
-    int size = SDL_RWsize(sdlFile);
-    std::vector<char> buffer(size);
-
-    SDL_RWread(sdlFile, buffer.data(), size, 1);
-    SDL_RWclose(sdlFile);
-
+    std::vector<char> buffer;
+    ResourceManager::getInstance()->readFile(path, buffer);
     return buffer;
   }
 
 public:
   VulkanPipelineResourceFactory(VulkanDevice *device, RendererParams params,
-                                VkRenderPass renderPass) {
+                                RenderPassKey renderPassKey) {
     this->device = device;
     this->resourceType = "vulkan_shader";
     this->params = params;
-    this->renderPass = renderPass;
+    this->renderPassKey = renderPassKey;
   }
 
-  std::shared_ptr<Resource> load(const std::string &path) {
-    SDL_RWops *sdlFile = SDL_RWFromFile(path.c_str(), "rb");
-
-    int size = SDL_RWsize(sdlFile);
-    std::vector<char> buffer(size);
-    SDL_RWread(sdlFile, buffer.data(), size, 1);
-    SDL_RWclose(sdlFile);
+  // Only creates device objects, so pipelines can be rebuilt off the render
+  // thread when their shaders change
+  bool supportsReload() { return true; }
 
-    std::string resourceContents(buffer.begin(), buffer.end());
+  std::shared_ptr<Resource> load(const std::string &path) {
+    std::vector<char> buffer;
+    ResourceManager::getInstance()->readFile(path, buffer);
 
     rapidjson::Document document;
-    document.Parse(resourceContents.c_str());
+    document.Parse(buffer.data(), buffer.size());
 
     spdlog::debug("Vert: {0} Frag: {1}", document["vertex_code"].GetString(),
                   document["fragment_code"].GetString());
@@ -53,7 +48,7 @@ public:
         readSpirv(document["fragment_code"].GetString());
 
     std::shared_ptr<VulkanPipelineResource> ptr(new VulkanPipelineResource(
-        device, params, renderPass, vertCode, fragCode));
+        device, params, renderPassKey, path, vertCode, fragCode));
     ptr->setResourceType(RESOURCE_VULKAN_PIPELINE);
     return std::static_pointer_cast<Resource>(ptr);
   }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Engine/Resources/ResourceId.h"
+
+class VulkanPipelineResource;
+class VulkanComputePipelineResource;
+class VulkanMeshResource;
+class VulkanMeshInstanceResource;
+class VulkanTextureResource;
+
+// Resources the renderer looks up every frame, hashed at compile time
+constexpr TypedResourceId<VulkanPipelineResource>
+    TEST_PIPELINE_RESOURCE("assets/shaders/test_vk_resource.json");
+constexpr TypedResourceId<VulkanPipelineResource>
+    CULLED_MESH_PIPELINE_RESOURCE("assets/shaders/culled_mesh.json");
+constexpr TypedResourceId<VulkanComputePipelineResource>
+    CULL_PIPELINE_RESOURCE("assets/shaders/compute/cull.json");
+constexpr TypedResourceId<VulkanMeshResource>
+    TEST_MESH_RESOURCE("assets/meshes/test_vk_mesh.json");
+constexpr TypedResourceId<VulkanMeshInstanceResource>
+    TEST_MESH_INSTANCE_RESOURCE("assets/meshes/test_vk_mesh_instance.json");
+constexpr TypedResourceId<VulkanTextureResource>
+    TEST_TEXTURE_RESOURCE("assets/textures/test_texture.json");
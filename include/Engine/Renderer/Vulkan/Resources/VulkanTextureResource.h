@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Engine/Resources/Resource.h"
+
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanImage.h"
+#include "Engine/Renderer/Vulkan/VulkanTextureContainer.h"
+
+class VulkanTextureStreamer;
+
+// Streamed textures start with their mips up to this size resident
+const uint32_t TEXTURE_STREAMING_BASE_SIZE = 64;
+
+// Sampled 2D texture. Block compressed sources are uploaded as stored,
+// uncompressed sources missing mips get them generated on the GPU. Textures
+// with a stored mip chain and a streamer only keep the mips from
+// getResidentMip() down in memory, the streamer moves that level up and down.
+class VulkanTextureResource : public Resource {
+private:
+  VulkanDevice *device;
+  VulkanTextureStreamer *streamer = nullptr;
+
+  std::string sourcePath;
+  // Mip layout of the source file, pixel data is read again when streaming
+  TextureData layout;
+  uint32_t mipCount;
+  uint32_t residentMip = 0;
+  // Lowest mip level any draw asked for since the streamer last looked
+  std::atomic<uint32_t> requestedMip;
+
+  VulkanImage *image = nullptr;
+  // Both owned by the device caches
+  VkImageView imageView = VK_NULL_HANDLE;
+  VkSampler sampler = VK_NULL_HANDLE;
+
+  void loadImage(const TextureData &texture, const std::vector<char> &data);
+  void createSampler(VkSamplerAddressMode addressMode);
+
+public:
+  VulkanTextureResource(VulkanDevice *device, VulkanTextureStreamer *streamer,
+                        const std::string &sourcePath,
+                        const TextureData &texture,
+                        const std::vector<char> &data,
+                        VkSamplerAddressMode addressMode);
+  ~VulkanTextureResource();
+
+  VkImage getImage();
+  VkImageView getImageView();
+  VkSampler getSampler();
+  uint32_t getMipLevels();
+
+  bool isStreamed();
+  // Mip level whose texels map closest to one pixel when the texture spans
+  // the given number of pixels on screen
+  uint32_t getMipForScreenSize(float pixels);
+  // Safe from any thread, keeps the most detailed request
+  void requestMip(uint32_t mip);
+  uint32_t takeRequestedMip();
+
+  const std::string &getSourcePath();
+  const TextureData &getLayout();
+  uint32_t getResidentMip();
+  uint32_t getStreamingBaseMip();
+  VkDeviceSize getResidentSize(uint32_t firstMip);
+  VulkanImage *getVulkanImage();
+
+  // Takes over an image holding the levels from residentMip on, the old one
+  // is destroyed once frames using it complete. Render thread only.
+  void swapImage(VulkanImage *image, uint32_t residentMip);
+};
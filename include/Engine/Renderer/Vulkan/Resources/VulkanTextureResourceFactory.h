@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanTextureResource.h"
+#include "Engine/Renderer/Vulkan/VulkanTextureStreamer.h"
+#include "Engine/Resources/ResourceFactory.h"
+#include "Engine/Resources/ResourceManager.h"
+
+class VulkanTextureResourceFactory : public ResourceFactory {
+private:
+  VulkanDevice *device;
+  // Optional, textures load fully resident without one
+  VulkanTextureStreamer *streamer;
+
+  VkSamplerAddressMode getAddressMode(const rapidjson::Document &document) {
+    if (document.HasMember("address_mode") &&
+        std::string(document["address_mode"].GetString()) == "clamp") {
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    }
+    return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  }
+
+public:
+  VulkanTextureResourceFactory(VulkanDevice *device,
+                               VulkanTextureStreamer *streamer = nullptr) {
+    this->device = device;
+    this->streamer = streamer;
+    this->resourceType = "vulkan_texture";
+  }
+
+  std::shared_ptr<Resource> load(const std::string &path) {
+    std::vector<char> buffer;
+    ResourceManager::getInstance()->readFile(path, buffer);
+
+    rapidjson::Document document;
+    document.Parse(buffer.data(), buffer.size());
+
+    // A KTX2 or DDS file holding the pixel data
+    std::string source = document["source"].GetString();
+    std::vector<char> data;
+    TextureData texture;
+    if (!ResourceManager::getInstance()->readFile(source, data) ||
+        !parseTextureContainer(data, texture)) {
+      spdlog::error("failed to load texture {0}", source);
+      return nullptr;
+    }
+
+    if (!device->supportsFormat(texture.format,
+                                VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+      spdlog::error("texture format {0} of {1} is not supported by the device",
+                    texture.format, source);
+      return nullptr;
+    }
+
+    std::shared_ptr<VulkanTextureResource> ptr(new VulkanTextureResource(
+        device, streamer, source, texture, data, getAddressMode(document)));
+    ptr->setResourceType(RESOURCE_VULKAN_TEXTURE);
+    return std::static_pointer_cast<Resource>(ptr);
+  }
+};
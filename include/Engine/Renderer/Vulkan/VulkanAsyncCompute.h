@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanRenderFrame.h"
+#include "Engine/Renderer/Vulkan/VulkanTimeline.h"
+
+// Compute work recorded on the async compute queue so it overlaps the
+// graphics work of the previous frame. Each frame slot has one command
+// buffer; its submission signals a semaphore the frame's graphics submission
+// waits on. Buffers written here and read by graphics need a queue family
+// release here and a matching acquire in the frame's command buffer.
+class VulkanAsyncCompute {
+private:
+  struct Slot {
+    VkCommandBuffer commandBuffer;
+    VkSemaphore finished;
+    // Completion of the slot's last submission on the compute timeline
+    uint64_t submitValue = 0;
+    bool recording = false;
+  };
+
+  VulkanDevice *device;
+  // The compute queue only orders its own submissions, so it gets a timeline
+  // separate from the one graphics signals
+  VulkanTimeline *timeline;
+  std::vector<Slot> slots;
+
+public:
+  VulkanAsyncCompute(VulkanDevice *device, int slotCount);
+  ~VulkanAsyncCompute();
+
+  // False when compute shares the graphics queue family, in which case
+  // dispatches are recorded straight into the frame's command buffer
+  bool isEnabled();
+  uint32_t getQueueFamily();
+
+  // The slot's command buffer, begun on the first call of the frame
+  VkCommandBuffer begin(const VulkanRenderFrame &frame);
+  // Submits what the frame recorded and makes its graphics submission wait
+  // for it at the given stages
+  void submit(VulkanRenderFrame &frame, VkPipelineStageFlags waitStages);
+};
@@ -14,8 +14,13 @@ private:
   VulkanDevice *device;
 
   VkDeviceSize size{0};
+  VkBufferUsageFlags usage;
+  VkDeviceSize allocationSize{0};
   uint8_t *mappedData{nullptr};
   bool mapped = false;
+  bool relocatable = false;
+  // Timeline value the buffer is freed at, 0 ties it to the current frame
+  uint64_t retireValue = 0;
 
   void map();
   void unmap();
@@ -25,14 +30,32 @@ public:
   VulkanBuffer(
       VulkanDevice *device, VkDeviceSize size, VkBufferUsageFlags buffer_usage,
       VmaMemoryUsage memory_usage,
-      VmaAllocationCreateFlags flags = VMA_ALLOCATION_CREATE_MAPPED_BIT);
+      VmaAllocationCreateFlags flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+      MEMORY_POOL pool = MEMORY_POOL_DEFAULT);
   ~VulkanBuffer();
 
   VkBuffer getBuffer();
+  VmaAllocation getAllocation();
+
+  // Lets the defragmenter move the buffer's memory, getBuffer() returns a
+  // new handle afterwards. Only for vertex and index buffers whose handle is
+  // fetched when recording, usage that can end up in a descriptor set is
+  // refused.
+  void setRelocatable();
+  // Recreates the handle on the allocation's current memory, the old handle
+  // is destroyed once frames using it complete
+  void rebind();
 
   void update(const void *data, size_t size, size_t offset);
 
-  void transferDataFrom(VulkanBuffer *otherBuffer);
+  // Records and submits the copy without waiting, returns the timeline value
+  // the copy completes at
+  uint64_t transferDataFrom(VulkanBuffer *otherBuffer);
+
+  // Frees the buffer once the timeline reaches value instead of with the
+  // current frame, for staging buffers only one upload reads
+  void retireAt(uint64_t value);
 
   VkDeviceSize getSize();
+  VkDeviceSize getAllocationSize();
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanComputePipelineResource.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanMeshResource.h"
+#include "Engine/Renderer/Vulkan/VulkanAsyncCompute.h"
+#include "Engine/Renderer/Vulkan/VulkanBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanRenderFrame.h"
+#include "Engine/Resources/ResourceManager.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+#include "Engine/Scene/RenderSnapshot.h"
+
+// Invocations per workgroup, matches local_size_x of the cull shader
+const uint32_t CULL_GROUP_SIZE = 64;
+
+// Layouts below mirror the std430 structs of the cull shader
+struct CullInstance {
+  glm::mat4 model;
+  uint32_t batch;
+  uint32_t padding[3];
+};
+
+// Instances sharing a mesh instance resource, drawn by one indirect count
+// call
+struct CullBatch {
+  // Model space bounding sphere of the mesh, xyz center and w radius
+  glm::vec4 bounds;
+  uint32_t indexCount;
+  // First command slot of the batch, one slot per instance
+  uint32_t commandOffset;
+  uint32_t padding[2];
+};
+
+struct CullPushConstants {
+  glm::vec4 frustumPlanes[6];
+  uint32_t instanceCount;
+};
+
+// Tests every mesh instance of a snapshot against the view frustum in a
+// compute dispatch and compacts the visible ones into indirect draw commands,
+// counted per mesh so the draw needs no readback. Runs on the async compute
+// queue when the device has one. Instance data persists across frames, the
+// CPU only touches the draws a snapshot reports as changed and walks the
+// batches, never every instance.
+class VulkanCullingPass {
+private:
+  struct FrameResources {
+    VulkanBuffer *instances;
+    VulkanBuffer *batches;
+    VulkanBuffer *commands;
+    VulkanBuffer *counts;
+    VulkanBuffer *visibleModels;
+    VkDescriptorSet cullSet;
+    VkDescriptorSet drawSet;
+    // Cull frame the instance buffer was last brought up to date in
+    uint64_t syncedFrame = 0;
+  };
+
+  VulkanDevice *device;
+  VulkanAsyncCompute *asyncCompute;
+  uint32_t maxInstances;
+  // Every batch has at least one instance
+  uint32_t maxBatches;
+  int frameCount;
+
+  // Resolved every frame so a hot reloaded cull shader is picked up
+  ResourceHandle<VulkanComputePipelineResource> pipelineHandle;
+  VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+  std::vector<FrameResources> frames;
+
+  // Instances in snapshot order, kept between frames
+  std::vector<CullInstance> instances;
+  uint32_t instanceCount = 0;
+  // Frame number of the snapshot the instances match. The changes of a
+  // snapshot that was never culled are lost, so a gap rebuilds every instance.
+  bool synced = false;
+  uint64_t snapshotFrame = 0;
+  uint64_t cullFrame = 0;
+  bool overflowWarned = false;
+
+  // Instances written in each of the last frameCount cull frames, indexed by
+  // cull frame modulo frameCount. Frame buffers catch up from these.
+  std::vector<std::vector<uint32_t>> changeHistory;
+  // Sorted changes one frame buffer is missing, reused between frames
+  std::vector<uint32_t> uploadIndices;
+
+  // A batch is assigned once per mesh instance resource and kept while
+  // instances use it, freed slots are reused by the next new one
+  FlatHashMap<uint32_t> handleBatches;
+  std::vector<ResourceHandle<VulkanMeshInstanceResource>> batchHandles;
+  // Resolved once per frame, null while the mesh is not loaded
+  std::vector<VulkanMeshResource *> batchMeshes;
+  std::vector<CullBatch> batches;
+  // Instances assigned to each batch, 0 for free slots
+  std::vector<uint32_t> batchSizes;
+  std::vector<uint32_t> freeBatches;
+  // Set when the current frame dispatched and has something to draw
+  bool culled = false;
+
+  void createBuffers();
+  void createDescriptors(VkDescriptorSetLayout drawSetLayout,
+                         const std::vector<VulkanBuffer *> &cameraBuffers);
+
+  uint32_t acquireBatch(ResourceHandle<VulkanMeshInstanceResource> handle);
+  void releaseBatch(uint32_t batch);
+  // Points an instance at a draw, assigned is set when it had a batch before
+  void writeInstance(uint32_t index, const MeshDraw &draw, bool assigned);
+  void syncInstances(const RenderSnapshot &snapshot);
+  void updateBatches();
+  void uploadInstances(FrameResources &resources);
+
+public:
+  // drawSetLayout is set 0 of the culled mesh pipeline, written with the
+  // frame's camera buffer at binding 0 and its visible models at binding 1
+  VulkanCullingPass(VulkanDevice *device, VulkanAsyncCompute *asyncCompute,
+                    uint32_t maxInstances, int frameCount,
+                    VkDescriptorSetLayout drawSetLayout,
+                    const std::vector<VulkanBuffer *> &cameraBuffers);
+  ~VulkanCullingPass();
+
+  // Needs indirect count draws and firstInstance in indirect commands
+  static bool isSupported(VulkanDevice *device);
+
+  // Records the cull dispatch, submitted right away on the async compute
+  // queue. Called before the frame's render pass begins.
+  void cull(VulkanRenderFrame &frame, const RenderSnapshot &snapshot);
+  // Records one indirect count draw per mesh culled this frame, with the
+  // culled mesh pipeline bound
+  void draw(const VulkanRenderFrame &frame, VkPipelineLayout drawLayout);
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "vk_mem_alloc.h"
+#include "volk.h"
+
+class VulkanDevice;
+class VulkanBuffer;
+
+// Upper bounds on what a single pass moves, keeping the copies queued ahead
+// of the next frame short
+const VkDeviceSize DEFRAGMENTATION_BYTES_PER_PASS = 8ull * 1024 * 1024;
+const uint32_t DEFRAGMENTATION_MOVES_PER_PASS = 64;
+
+struct FragmentationStats {
+  VkDeviceSize usedBytes;
+  VkDeviceSize unusedBytes;
+  VkDeviceSize largestUnusedRange;
+  uint32_t blockCount;
+
+  // 0 when all free memory is one range, towards 1 the more it is split
+  float getFragmentation() const {
+    return unusedBytes > 0 ? 1.0f - static_cast<float>(largestUnusedRange) /
+                                        static_cast<float>(unusedBytes)
+                           : 0.0f;
+  }
+};
+
+// Compacts the allocations of relocatable buffers a bounded step at a time
+// with VMA's defragmentation. A pass records the copies on the graphics
+// queue and recreates each moved buffer on its new memory right away, frames
+// submitted later are ordered after the copies. The render thread never
+// waits for a pass, it is ended in a later update once the GPU reached it.
+// Passes start after buffers are freed and stop once a pass has nothing left
+// to move. Images are never moved, they are bound in descriptor sets and
+// would need their views and sets rebuilt.
+class VulkanDefragmenter {
+private:
+  VulkanDevice *device;
+
+  std::vector<VulkanBuffer *> buffers;
+  std::mutex mutex;
+
+  // Copies of the last pass still running on the GPU, the context must be
+  // ended before another pass starts or a moved allocation is freed
+  bool passPending = false;
+  VmaDefragmentationContext pendingContext;
+  uint64_t pendingValue = 0;
+  std::vector<VmaAllocation> pendingAllocations;
+  // Deleters of buffers freed while their allocation was part of the pass,
+  // handed to the deletion queue once it ends
+  std::vector<std::function<void()>> pendingDeleters;
+
+  // Set when memory was freed, cleared once a pass finds nothing to move
+  bool fragmented = false;
+  FragmentationStats statsBefore;
+  VkDeviceSize bytesMoved = 0;
+  uint32_t allocationsMoved = 0;
+
+  // Queues moves up to the per pass limits, returns whether anything moved
+  bool runPass();
+  // Ends the pending pass, waiting for its copies when block is set.
+  // Returns whether no pass is pending anymore.
+  bool finishPass(bool block);
+
+public:
+  VulkanDefragmenter(VulkanDevice *device);
+  // Before the allocator and the timeline go away
+  ~VulkanDefragmenter();
+
+  FragmentationStats getFragmentationStats();
+
+  // Only buffers fetched by handle when recording, nothing rewrites
+  // descriptor sets after a move
+  void registerBuffer(VulkanBuffer *buffer);
+  // Defers the deleter freeing the buffer, held back until the pending pass
+  // ends when the allocation is part of it
+  void unregisterBuffer(VulkanBuffer *buffer, std::function<void()> deleter);
+
+  // Render thread, once per frame outside of command recording
+  void update();
+};
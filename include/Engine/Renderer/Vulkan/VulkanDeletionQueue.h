@@ -0,0 +1,44 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Engine/Renderer/Vulkan/VulkanTimeline.h"
+
+// Holds destruction of Vulkan objects until every frame that could still
+// reference them has completed on the GPU. Objects deferred while a frame is
+// being prepared are retired together with that frame's timeline value,
+// objects used by a single submission can be retired at its value instead.
+class VulkanDeletionQueue {
+private:
+  VulkanTimeline *timeline;
+
+  std::mutex mutex;
+  std::vector<std::function<void()>> currentFrame;
+  std::deque<std::pair<uint64_t, std::vector<std::function<void()>>>>
+      pendingFrames;
+
+  // Keeps pendingFrames ordered by value, expects the lock to be held
+  void insertPending(uint64_t value,
+                     std::vector<std::function<void()>> deleters);
+
+public:
+  VulkanDeletionQueue(VulkanTimeline *timeline);
+  ~VulkanDeletionQueue();
+
+  void defer(std::function<void()> deleter);
+  // Runs the deleter once the timeline reaches value, for objects no frame
+  // references such as upload staging buffers and command buffers
+  void defer(uint64_t value, std::function<void()> deleter);
+
+  // Ties everything deferred so far to the submission signalling value
+  void endFrame(uint64_t value);
+
+  // Runs the deleters of every frame the GPU has finished
+  void collect();
+
+  // Waits for all submitted work and runs every deleter, used at shutdown
+  void flush();
+};
\ No newline at end of file
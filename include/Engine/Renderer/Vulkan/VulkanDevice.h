@@ -1,11 +1,26 @@
 #pragma once
 
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "volk.h"
 #include "vk_mem_alloc.h"
 
 #include "spdlog/spdlog.h"
 
+#include "Engine/Renderer/Vulkan/VulkanDeletionQueue.h"
+#include "Engine/Renderer/Vulkan/VulkanImageViewCache.h"
+#include "Engine/Renderer/Vulkan/VulkanMemoryPools.h"
+#include "Engine/Renderer/Vulkan/VulkanMemoryStats.h"
+#include "Engine/Renderer/Vulkan/VulkanPipelineLayoutCache.h"
+#include "Engine/Renderer/Vulkan/VulkanPipelineVariantLog.h"
+#include "Engine/Renderer/Vulkan/VulkanRenderPassCache.h"
+#include "Engine/Renderer/Vulkan/VulkanSamplerCache.h"
+#include "Engine/Renderer/Vulkan/VulkanTimeline.h"
+
+class VulkanDefragmenter;
+
 class VulkanDevice {
   VkInstance instance;
   VkPhysicalDevice physicalDevice;
@@ -17,15 +32,43 @@ class VulkanDevice {
   VkPhysicalDeviceMemoryProperties memoryProperties;
 
   VkQueue graphicsQueue;
+  // The graphics queue unless a compute only family exists
+  VkQueue computeQueue;
 
   std::vector<std::string> supportedExtensions;
   std::vector<VkQueueFamilyProperties> queueFamilyProperties;
 
   VkCommandPool commandPool = VK_NULL_HANDLE;
+  VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+  // A pool and its command buffers can only be used by one thread at a time,
+  // each thread recording uploads gets its own. Buffers the GPU is done with
+  // are handed back by the deletion queue and freed by the owning thread.
+  struct TransferCommandPool {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> retired;
+  };
+  std::unordered_map<std::thread::id, TransferCommandPool>
+      transferCommandPools;
+  std::mutex transferPoolMutex;
+  VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+  VulkanPipelineLayoutCache *layoutCache = nullptr;
+  VulkanPipelineVariantLog *variantLog = nullptr;
+  VulkanRenderPassCache *renderPassCache = nullptr;
+  VulkanSamplerCache *samplerCache = nullptr;
+  VulkanImageViewCache *imageViewCache = nullptr;
 
   VmaAllocator allocator;
+  VulkanMemoryPools *memoryPools = nullptr;
+  VulkanDefragmenter *defragmenter = nullptr;
+  VulkanMemoryStats *memoryStats = nullptr;
+
+  VulkanTimeline *timeline = nullptr;
+  VulkanDeletionQueue *deletionQueue = nullptr;
 
   bool enableDebugMarkers = false;
+  bool enableTimelineSemaphores = false;
+  bool enableMemoryBudget = false;
+  bool enableDrawIndirectCount = false;
 
   uint32_t getQueueFamilyIndex(VkQueueFlagBits queueFlags);
 
@@ -55,9 +98,50 @@ public:
                       VkQueueFlags requestedQueueTypes = VK_QUEUE_GRAPHICS_BIT |
                                                          VK_QUEUE_COMPUTE_BIT);
   void initAllocator();
+  void initTimeline();
+  void initPipelineCache();
+  void initResourceCaches();
   VmaAllocator getAllocator();
+  VulkanMemoryPools *getMemoryPools();
+  VulkanDefragmenter *getDefragmenter();
+  VulkanMemoryStats *getMemoryStats();
+  bool isMemoryBudgetEnabled();
+  // vkCmdDrawIndexedIndirectCountKHR is available
+  bool isDrawIndirectCountEnabled();
+  VulkanTimeline *getTimeline();
+  VulkanDeletionQueue *getDeletionQueue();
+
+  // Usage and budget summed over device local heaps, reported by
+  // VK_EXT_memory_budget when available and estimated by VMA otherwise
+  void getMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget);
+  // Render thread only, loaders record into their transfer pool
   VkCommandPool getCommandPool();
+  // On the compute family, the graphics pool when there is none
+  VkCommandPool getComputeCommandPool();
+  // One time transfer commands recorded on the calling thread's graphics
+  // family pool. Submitting does not wait, the command buffer is retired
+  // through the deletion queue and the returned timeline value marks
+  // completion.
+  VkCommandBuffer beginTransferCommands();
+  uint64_t submitTransferCommands(VkCommandBuffer commandBuffer);
+  // Internally synchronised, shared by pipelines built on any thread
+  VkPipelineCache getPipelineCache();
+  VulkanPipelineLayoutCache *getLayoutCache();
+  VulkanPipelineVariantLog *getVariantLog();
+  VulkanRenderPassCache *getRenderPassCache();
+  // Both internally synchronised, shared by loaders on any thread
+  VulkanSamplerCache *getSamplerCache();
+  VulkanImageViewCache *getImageViewCache();
   VkPhysicalDevice getPhysicalDevice();
+  VkPhysicalDeviceProperties getProperties();
+  VkPhysicalDeviceMemoryProperties getMemoryProperties();
+  // Supported by the physical device, versus enabled on the logical one
+  VkPhysicalDeviceFeatures getFeatures();
+  VkPhysicalDeviceFeatures getEnabledFeatures();
+  bool supportsFormat(VkFormat format, VkFormatFeatureFlags featureFlags);
   VkDevice getDevice();
   VkQueue getGraphicsQueue();
+  VkQueue getComputeQueue();
+  // Compute runs on its own queue family and can overlap graphics work
+  bool hasAsyncCompute();
 };
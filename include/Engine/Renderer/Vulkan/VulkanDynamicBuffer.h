@@ -44,7 +44,7 @@ VulkanDynamicBuffer<T>::VulkanDynamicBuffer(VulkanDevice* device, uint32_t maxIn
   this->maxInstances = maxInstances;
   findDynamicAlignment();
 
-  buffer = new VulkanBuffer(device, dynamicAlignment * maxInstances, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+  buffer = new VulkanBuffer(device, dynamicAlignment * maxInstances, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_ALLOCATION_CREATE_MAPPED_BIT, MEMORY_POOL_FRAME);
 }
 
 template <class T>
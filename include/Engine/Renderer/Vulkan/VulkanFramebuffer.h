@@ -14,5 +14,5 @@ public:
     spdlog::debug("destroying framebuffer");
   }
 
-  VkFramebuffer framebuffer;
+  VkFramebuffer framebuffer = VK_NULL_HANDLE;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "volk.h"
 #include "vk_mem_alloc.h"
 
@@ -9,20 +11,62 @@
 class VulkanImage {
 private:
   VulkanDevice *device;
-  VkImage image;
+  VkImage image = VK_NULL_HANDLE;
   VmaAllocation allocation = VK_NULL_HANDLE;
   VkDeviceMemory memory;
+  VkDeviceSize allocationSize = 0;
 
   int width, height;
+  VkFormat format;
+  uint32_t mipLevels;
 
-  void transitionLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+  void recordBarrier(VkCommandBuffer commandBuffer, uint32_t baseMip,
+                     uint32_t levelCount, VkImageLayout oldLayout,
+                     VkImageLayout newLayout, VkAccessFlags srcAccess,
+                     VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+                     VkPipelineStageFlags dstStage);
+  // Fills levels from firstLevel on by repeatedly halving the level above,
+  // leaves every level it touches ready for sampling
+  void recordMipChain(VkCommandBuffer commandBuffer, uint32_t firstLevel);
 
 public:
   VulkanImage(
-      VulkanDevice *device, int width, int height, VkImageUsageFlags imageUsage,
+      VulkanDevice *device, int width, int height, VkFormat format,
+      uint32_t mipLevels, VkImageUsageFlags imageUsage,
       VmaMemoryUsage memoryUsage,
-      VmaAllocationCreateFlags flags = VMA_ALLOCATION_CREATE_MAPPED_BIT);
+      VmaAllocationCreateFlags flags = 0,
+      MEMORY_POOL pool = MEMORY_POOL_DEFAULT);
   ~VulkanImage();
 
-  void transferFromBuffer(VulkanBuffer* buffer);
-};
\ No newline at end of file
+  // Copies the given regions from the buffer, one or more per level starting
+  // at the base, then blits down the remaining levels when generateMips is
+  // set. The image ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+  // Submits without waiting and returns the timeline value that marks
+  // completion.
+  uint64_t upload(VulkanBuffer *buffer,
+                  const std::vector<VkBufferImageCopy> &regions,
+                  uint32_t uploadedLevels, bool generateMips);
+
+  // Builds this image from new levels in the buffer and levels copied out of
+  // another image holding the same texture at a different mip range, used to
+  // grow and shrink streamed textures. Submits without waiting and returns
+  // the timeline value that marks completion.
+  uint64_t streamFrom(VulkanBuffer *buffer,
+                      const std::vector<VkBufferImageCopy> &regions,
+                      VulkanImage *source, uint32_t sourceLevel,
+                      uint32_t targetLevel, uint32_t levelCount);
+
+  // Whether the device can blit and linearly filter the format, which mip
+  // generation relies on
+  static bool canGenerateMips(VulkanDevice *device, VkFormat format);
+
+  VkImage getImage();
+  // 2D view of every level from the device's view cache, released together
+  // with the image
+  VkImageView getView(VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+  int getWidth();
+  int getHeight();
+  VkFormat getFormat();
+  uint32_t getMipLevels();
+  VkDeviceSize getAllocationSize();
+};
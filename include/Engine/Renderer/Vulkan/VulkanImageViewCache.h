@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/VulkanDeletionQueue.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+#include "Engine/Resources/Utils/PathHash.h"
+
+// Image views keyed by image, view type, format, swizzle and subresource
+// range, so everything viewing the same part of an image the same way shares
+// one VkImageView. Keys are hashed for the lookup and compared in full. Views of an image are destroyed together once the image
+// is released, after the frames that may still use them.
+class VulkanImageViewCache {
+private:
+  // Create info fields views are told apart by, the image handle first
+  typedef std::array<uint64_t, 13> ImageViewKey;
+
+  struct CachedImageView {
+    ImageViewKey key;
+    VkImageView imageView;
+  };
+
+  struct ImageViewRef {
+    VkImage image;
+    uint64_t hash;
+  };
+
+  VkDevice device;
+  VulkanDeletionQueue *deletionQueue;
+
+  // Every view whose key hashes to the map key
+  FlatHashMap<std::vector<CachedImageView>> imageViews;
+  // Hashes of the views created for each image, keyed by the hash of the
+  // image handle
+  FlatHashMap<std::vector<ImageViewRef>> imageRefs;
+  std::mutex mutex;
+
+  static ImageViewKey getImageViewKey(const VkImageViewCreateInfo &createInfo);
+
+public:
+  VulkanImageViewCache(VkDevice device, VulkanDeletionQueue *deletionQueue);
+  ~VulkanImageViewCache();
+
+  // Extension structs in pNext are not part of the key and must not be set
+  VkImageView getImageView(const VkImageViewCreateInfo &createInfo);
+
+  // Called by the owner of the image when destroying it
+  void releaseImage(VkImage image);
+};
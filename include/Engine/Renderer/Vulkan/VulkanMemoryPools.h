@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "vk_mem_alloc.h"
+#include "volk.h"
+
+typedef enum {
+  // Not pooled, allocated straight from the VMA default pools
+  MEMORY_POOL_DEFAULT = 0,
+  // Host visible uniform and dynamic data written every frame
+  MEMORY_POOL_FRAME = 1,
+  // Host only upload sources, short lived but freed in any order
+  MEMORY_POOL_STAGING = 2,
+  // Device local vertex and index data
+  MEMORY_POOL_MESH = 3,
+  // Device local sampled images
+  MEMORY_POOL_TEXTURE = 4,
+  MEMORY_POOL_COUNT = 5
+} MEMORY_POOL;
+
+// Single blocks for the frame and staging pools
+const VkDeviceSize FRAME_POOL_SIZE = 16ull * 1024 * 1024;
+const VkDeviceSize STAGING_POOL_SIZE = 64ull * 1024 * 1024;
+// Block sizes for the general purpose pools, which grow a block at a time
+const VkDeviceSize MESH_POOL_BLOCK_SIZE = 64ull * 1024 * 1024;
+const VkDeviceSize TEXTURE_POOL_BLOCK_SIZE = 128ull * 1024 * 1024;
+
+struct MemoryPoolStats {
+  const char *name;
+  VkDeviceSize size;
+  VkDeviceSize unusedSize;
+  size_t allocationCount;
+  size_t blockCount;
+};
+
+// Named VMA custom pools the buffers and images are placed in by lifetime.
+// The frame and staging pools each allocate one block up front and never
+// touch vkAllocateMemory after creation. The frame pool uses the linear
+// algorithm, its buffers are created once and live as long as the renderer.
+// Staging buffers are retired at the timeline value of their own upload, and
+// uploads from different loader threads and the texture streamer complete in
+// any order, so the staging pool uses the general algorithm to reuse freed
+// ranges wherever they are. Allocations that do not fit a pool fall back to
+// the default pools, see VulkanBuffer and VulkanImage.
+class VulkanMemoryPools {
+private:
+  VmaAllocator allocator;
+  VmaPool pools[MEMORY_POOL_COUNT] = {};
+
+  VmaPool createBufferPool(MEMORY_POOL pool, VkBufferUsageFlags usage,
+                           VmaMemoryUsage memoryUsage,
+                           VmaPoolCreateFlags flags, VkDeviceSize blockSize,
+                           size_t maxBlockCount);
+  VmaPool createImagePool(MEMORY_POOL pool, VkImageUsageFlags usage,
+                          VkDeviceSize blockSize);
+
+public:
+  VulkanMemoryPools(VmaAllocator allocator);
+  ~VulkanMemoryPools();
+
+  // VK_NULL_HANDLE for the default pool or a pool that failed to create
+  VmaPool getPool(MEMORY_POOL pool);
+
+  static const char *getPoolName(MEMORY_POOL pool);
+
+  std::vector<MemoryPoolStats> getPoolStats();
+  // Per pool usage followed by the allocator wide totals
+  void logStats();
+};
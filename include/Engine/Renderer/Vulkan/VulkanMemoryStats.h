@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "vk_mem_alloc.h"
+#include "volk.h"
+
+class VulkanDevice;
+
+const char GPU_MEMORY_STATS_PATH[] = "gpu_memory_stats.json";
+
+struct HeapStats {
+  VkDeviceSize size = 0;
+  VkMemoryHeapFlags flags = 0;
+  VkDeviceSize usage = 0;
+  VkDeviceSize budget = 0;
+  VkDeviceSize peakUsage = 0;
+};
+
+struct AllocationRate {
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  VkDeviceSize allocatedBytes = 0;
+  VkDeviceSize freedBytes = 0;
+};
+
+// Tracks GPU memory for hunting regressions: usage against budget per heap
+// (exact with VK_EXT_memory_budget, estimated by VMA otherwise) with its
+// peak, and how many allocations buffers and images make each frame.
+// writeSnapshot adds VMA's detailed map and the bytes held per resource type.
+class VulkanMemoryStats {
+private:
+  VulkanDevice *device;
+
+  std::vector<HeapStats> heaps;
+  uint32_t frameIndex = 0;
+
+  // Counted as they happen on any thread, folded into a frame by update()
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> frees{0};
+  std::atomic<VkDeviceSize> allocatedBytes{0};
+  std::atomic<VkDeviceSize> freedBytes{0};
+
+  AllocationRate lastFrame;
+  AllocationRate peakFrame;
+
+  std::mutex mutex;
+
+public:
+  VulkanMemoryStats(VulkanDevice *device);
+
+  void recordAllocation(VkDeviceSize size);
+  void recordFree(VkDeviceSize size);
+
+  // Once per frame, also lets VMA refresh its budget numbers
+  void update();
+
+  std::vector<HeapStats> getHeapStats();
+  AllocationRate getLastFrame();
+  AllocationRate getPeakFrame();
+
+  bool writeSnapshot(const std::string &filepath);
+};
@@ -5,11 +5,11 @@
 #include "Engine/Renderer/Vulkan/VulkanRenderer.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshInstanceResource.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanPipelineResource.h"
-#include "Engine/Renderer/Vulkan/VulkanDynamicBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanCullingPass.h"
 #include "Engine/Renderer/Vulkan/VulkanRenderFrame.h"
 
-#include "Engine/Scene/Node.h"
-#include "Engine/Scene/Actor.h"
+#include "Engine/Scene/RenderSnapshot.h"
 
 #include <chrono>
 
@@ -17,8 +17,13 @@ class VulkanMeshRenderManager : public RenderManager
 {
 private:
   VulkanDevice *device;
-  std::shared_ptr<VulkanPipelineResource> pipeline;
-  std::vector<VulkanDynamicBuffer<glm::mat4>*> uniformBuffers;
+  VulkanAsyncCompute *asyncCompute;
+  // Resolved every frame so a hot reloaded pipeline is picked up
+  ResourceHandle<VulkanPipelineResource> pipelineHandle;
+  // Draws the instances left by the culling pass, null without GPU culling
+  ResourceHandle<VulkanPipelineResource> culledPipelineHandle;
+  VulkanCullingPass *cullingPass = nullptr;
+  std::vector<VulkanBuffer*> cameraBuffers;
   std::vector<VkDescriptorPool> descriptorPools;
   std::vector<VkDescriptorSet> descriptorSets;
   int maxObjects = 0;
@@ -26,9 +31,14 @@ private:
 
   void initBuffers();
   void initDescriptors();
+  void initCulling();
+
+  void drawCulled(const VulkanRenderFrame& frame);
 public:
-  VulkanMeshRenderManager(VulkanDevice *device, int maxObjects, int frameCount);
+  VulkanMeshRenderManager(VulkanDevice *device, VulkanAsyncCompute *asyncCompute, int maxObjects, int frameCount);
   ~VulkanMeshRenderManager();
 
-  void draw(const VulkanRenderFrame& frame, const std::vector<Node*>& drawList);
+  // Recorded before the render pass begins: camera upload and GPU culling
+  void prepare(VulkanRenderFrame& frame, const RenderSnapshot& snapshot);
+  void draw(const VulkanRenderFrame& frame, const RenderSnapshot& snapshot);
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/VulkanShaderReflection.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+#include "Engine/Resources/Utils/PathHash.h"
+
+// Descriptor set and pipeline layouts keyed by their definition, so pipelines
+// with the same interface share one layout object. Definitions are hashed
+// for the lookup and compared in full, so colliding hashes stay apart. Layouts live as
+// long as the device, which keeps descriptor sets allocated against them
+// valid for every pipeline using the same signature.
+class VulkanPipelineLayoutCache {
+private:
+  struct CachedSetLayout {
+    std::vector<uint32_t> signature;
+    VkDescriptorSetLayout layout;
+  };
+
+  struct CachedPipelineLayout {
+    std::vector<uint64_t> signature;
+    VkPipelineLayout layout;
+  };
+
+  VkDevice device;
+
+  // Every layout whose signature hashes to the key
+  FlatHashMap<std::vector<CachedSetLayout>> descriptorSetLayouts;
+  FlatHashMap<std::vector<CachedPipelineLayout>> pipelineLayouts;
+
+  std::mutex mutex;
+
+  VkDescriptorSetLayout
+  getDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+public:
+  VulkanPipelineLayoutCache(VkDevice device);
+  ~VulkanPipelineLayoutCache();
+
+  // Layouts for every set index up to the highest the reflection uses, sets
+  // without bindings get an empty layout
+  std::vector<VkDescriptorSetLayout>
+  getDescriptorSetLayouts(const ShaderReflection &reflection);
+
+  VkPipelineLayout
+  getPipelineLayout(const std::vector<VkDescriptorSetLayout> &setLayouts,
+                    const std::vector<VkPushConstantRange> &pushConstantRanges);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "volk.h"
+
+#include "Engine/Resources/Utils/PathHash.h"
+
+// Fixed function state a pipeline variant is built with, everything else
+// comes from the shaders or is dynamic
+struct PipelineState {
+  VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+  VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+  VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  VkBool32 blendEnable = VK_FALSE;
+  VkBool32 depthTestEnable = VK_FALSE;
+  VkBool32 depthWriteEnable = VK_FALSE;
+  VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+  uint64_t getHash() const {
+    uint32_t fields[] = {static_cast<uint32_t>(topology),
+                         static_cast<uint32_t>(polygonMode),
+                         static_cast<uint32_t>(cullMode),
+                         static_cast<uint32_t>(frontFace),
+                         blendEnable,
+                         depthTestEnable,
+                         depthWriteEnable,
+                         static_cast<uint32_t>(depthCompareOp)};
+    return hashBytes(fields, sizeof(fields));
+  }
+};
+
+// What makes two render passes compatible for the pipelines built against
+// them: attachment formats and sample counts
+struct RenderPassKey {
+  VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+  VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+  VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+  uint64_t getHash() const {
+    uint32_t fields[] = {static_cast<uint32_t>(colorFormat),
+                         static_cast<uint32_t>(depthFormat),
+                         static_cast<uint32_t>(samples)};
+    return hashBytes(fields, sizeof(fields));
+  }
+
+  bool operator==(const RenderPassKey &other) const {
+    return colorFormat == other.colorFormat &&
+           depthFormat == other.depthFormat && samples == other.samples;
+  }
+};
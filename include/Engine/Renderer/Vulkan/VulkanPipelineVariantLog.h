@@ -0,0 +1,35 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "Engine/Renderer/Vulkan/VulkanPipelineState.h"
+
+const char PIPELINE_VARIANT_LOG_PATH[] = "pipeline_variants.json";
+
+struct PipelineVariant {
+  std::string path;
+  PipelineState state;
+  RenderPassKey renderPassKey;
+};
+
+// Every pipeline variant created, kept across runs so pipelines can build the
+// variants they needed last time as soon as they load instead of on first use
+class VulkanPipelineVariantLog {
+private:
+  std::vector<PipelineVariant> variants;
+  std::mutex mutex;
+
+  bool contains(const PipelineVariant &variant);
+
+public:
+  void record(const PipelineVariant &variant);
+  std::vector<PipelineVariant> getVariants(const std::string &path,
+                                           const RenderPassKey &renderPassKey);
+
+  bool load(const std::string &filepath);
+  bool save(const std::string &filepath);
+};
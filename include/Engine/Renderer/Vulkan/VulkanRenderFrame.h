@@ -1,7 +1,12 @@
 #pragma once
 
+#include "spdlog/spdlog.h"
 #include "volk.h"
 #include "Engine/Renderer/RenderFrame.h"
+#include "Engine/Renderer/Vulkan/VulkanPipelineState.h"
+
+// Semaphores of other queues one frame can wait on, besides the swapchain's
+const uint32_t MAX_FRAME_WAIT_SEMAPHORES = 4;
 
 class VulkanRenderFrame {
 public:
@@ -9,17 +14,44 @@ public:
   int currentFrameIndex;
   uint32_t currentImageIndex;
   VkRenderPassBeginInfo renderPassBeginInfo;
+  // Pipelines drawn in this frame must be compatible with this key
+  RenderPassKey renderPassKey;
+  VkExtent2D extent;
 
   VkViewport viewport;
   VkRect2D scissor;
 
   VkCommandBufferBeginInfo beginInfo;
 
+  // Work on other queues the frame's submission waits for, besides the
+  // swapchain image
+  VkSemaphore waitSemaphores[MAX_FRAME_WAIT_SEMAPHORES];
+  VkPipelineStageFlags waitStages[MAX_FRAME_WAIT_SEMAPHORES];
+  uint32_t waitSemaphoreCount = 0;
+
+  void waitFor(VkSemaphore semaphore, VkPipelineStageFlags stages) {
+    if (waitSemaphoreCount == MAX_FRAME_WAIT_SEMAPHORES) {
+      spdlog::error("frame waits on more than {0} semaphores", MAX_FRAME_WAIT_SEMAPHORES);
+      return;
+    }
+    waitSemaphores[waitSemaphoreCount] = semaphore;
+    waitStages[waitSemaphoreCount] = stages;
+    waitSemaphoreCount++;
+  }
+
   void begin() {
+    beginCommands();
+    beginRenderPass();
+  }
+
+  // Split for work recorded before the render pass, like compute dispatches
+  void beginCommands() {
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
       spdlog::error("failed to begin vulkan command buffer");
     }
+  }
 
+  void beginRenderPass() {
     vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
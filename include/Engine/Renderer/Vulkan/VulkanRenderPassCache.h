@@ -0,0 +1,28 @@
+#pragma once
+
+#include <mutex>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Renderer/Vulkan/VulkanPipelineState.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+
+// One render pass per compatibility key for the lifetime of the device.
+// Pipelines and framebuffers are built against the pass for their key, so
+// recreating the swapchain with the same formats never invalidates them.
+class VulkanRenderPassCache {
+private:
+  VkDevice device;
+
+  FlatHashMap<VkRenderPass> renderPasses;
+  std::mutex mutex;
+
+  VkRenderPass createRenderPass(const RenderPassKey &renderPassKey);
+
+public:
+  VulkanRenderPassCache(VkDevice device);
+  ~VulkanRenderPassCache();
+
+  VkRenderPass getRenderPass(const RenderPassKey &renderPassKey);
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <stdexcept>
 #include <vector>
 
@@ -11,6 +12,7 @@
 
 #include "Engine/Renderer/Renderer.h"
 
+#include "Engine/Renderer/Vulkan/VulkanAsyncCompute.h"
 #include "Engine/Renderer/Vulkan/VulkanBuffer.h"
 #include "Engine/Renderer/Vulkan/VulkanFramebuffer.h"
 #include "Engine/Renderer/Vulkan/VulkanSwapchain.h"
@@ -20,6 +22,7 @@
 
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshResource.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanPipelineResource.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanResourceIds.h"
 #include "Engine/Resources/ResourceManager.h"
 
 const std::vector<const char *> validationLayers = {
@@ -30,6 +33,10 @@ const std::vector<const char *> deviceExtensions = {
 
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
+// Render snapshots shared between the simulation and render threads, the
+// simulation can run up to FRAME_PIPELINE_DEPTH - 1 frames ahead
+const int FRAME_PIPELINE_DEPTH = 2;
+
 class VulkanRenderer {
 private:
   ResourceManager *resourceManager;
@@ -47,6 +54,7 @@ private:
 
   VulkanDevice *device;
   VulkanSwapchain *swapchain;
+  VulkanAsyncCompute *asyncCompute;
 
   VkViewport viewport;
 
@@ -58,16 +66,24 @@ private:
 
   VkPhysicalDeviceFeatures deviceFeatures = {};
 
+  // Owned by the device's render pass cache
   VkRenderPass renderPass;
+  RenderPassKey renderPassKey;
   VkRect2D scissor;
 
   std::vector<VkSemaphore> imageAvailableSemaphores;
   std::vector<VkSemaphore> renderFinishedSemaphores;
-  std::vector<VkFence> inFlightFences;
-  std::vector<VkFence> imagesInFlight;
+  // Timeline values signalled by the last submission of each frame slot and
+  // of each swapchain image, 0 when nothing was submitted yet
+  std::vector<uint64_t> framesInFlight;
+  std::vector<uint64_t> imagesInFlight;
 
   size_t currentFrame = 0;
 
+  // Set by window resize events and out of date presents, the swapchain is
+  // recreated once at the start of the next frame however many arrived
+  std::atomic<bool> resizePending{false};
+
   VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
 
   void initSDL();
@@ -81,24 +97,31 @@ private:
   void initRenderPass();
   void initFramebuffers();
   void initCommandBuffers();
+  void retireFramebuffers();
   void initSemaphores();
+  void updateResourceBudget();
 
 public:
   VulkanRenderer(const RendererParams &params);
   ~VulkanRenderer();
   bool checkValidationLayerSupport();
   void init();
-  void beginFrame();
   void drawFrame();
   void finishFrame();
-  void buildCommandbuffers();
-  void recreateSwapchain();
-
-  VulkanRenderFrame prepareFrame();
+  // False while the window is minimized and the swapchain can't be rebuilt
+  bool recreateSwapchain();
+  bool isMinimized();
+  void requestResize();
+
+  // False when no image could be acquired, the frame is skipped and nothing
+  // must be recorded or submitted
+  bool prepareFrame(VulkanRenderFrame &renderFrame);
   void submitFrame(VulkanRenderFrame &frame);
 
   VulkanDevice *getDevice();
+  VulkanAsyncCompute *getAsyncCompute();
   VkRenderPass getRenderPass();
+  RenderPassKey getRenderPassKey();
 
   int getFrameCount();
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Resources/Utils/FlatHashMap.h"
+#include "Engine/Resources/Utils/PathHash.h"
+
+// Samplers keyed by their create info, so every texture asking for the same
+// filtering and addressing shares one VkSampler. The create info is hashed
+// for the lookup and compared in full. Devices may only
+// guarantee a few thousand samplers in total, textures can far outnumber
+// that. Samplers live as long as the device.
+class VulkanSamplerCache {
+private:
+  // Create info fields samplers are told apart by, floats by their bits
+  typedef std::array<uint32_t, 16> SamplerKey;
+
+  struct CachedSampler {
+    SamplerKey key;
+    VkSampler sampler;
+  };
+
+  VkDevice device;
+  uint32_t maxSamplers;
+
+  // Every sampler whose key hashes to the map key
+  FlatHashMap<std::vector<CachedSampler>> samplers;
+  size_t samplerCount = 0;
+  std::mutex mutex;
+
+  static SamplerKey getSamplerKey(const VkSamplerCreateInfo &createInfo);
+
+public:
+  VulkanSamplerCache(VkDevice device, uint32_t maxSamplers);
+  ~VulkanSamplerCache();
+
+  // Extension structs in pNext are not part of the key and must not be set
+  VkSampler getSampler(const VkSamplerCreateInfo &createInfo);
+
+  size_t getSamplerCount();
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+struct ShaderBinding {
+  uint32_t set;
+  uint32_t binding;
+  VkDescriptorType descriptorType;
+  uint32_t descriptorCount;
+  VkShaderStageFlags stageFlags;
+};
+
+struct ShaderInput {
+  uint32_t location;
+  VkFormat format;
+};
+
+// Interface of one or more shader stages as declared in their SPIR-V, enough
+// to build descriptor set and pipeline layouts without restating them in code
+struct ShaderReflection {
+  VkShaderStageFlags stageFlags = 0;
+  std::vector<ShaderBinding> bindings;
+
+  uint32_t pushConstantSize = 0;
+  VkShaderStageFlags pushConstantStages = 0;
+
+  // Vertex stage inputs, built-ins excluded
+  std::vector<ShaderInput> inputs;
+
+  // Folds in another stage, bindings declared by both are shared
+  void merge(const ShaderReflection &other);
+
+  // Highest descriptor set index in use plus one
+  uint32_t getSetCount() const;
+};
+
+bool reflectShader(const std::vector<char> &code, ShaderReflection &reflection);
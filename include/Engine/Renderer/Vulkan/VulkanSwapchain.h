@@ -3,6 +3,7 @@
 #include "SDL_vulkan.h"
 #include "spdlog/spdlog.h"
 
+#include "Engine/Renderer/Vulkan/VulkanDeletionQueue.h"
 #include "Engine/Renderer/Vulkan/VulkanUtils.h"
 
 typedef struct _SwapChainBuffers {
@@ -16,6 +17,7 @@ private:
   VkPhysicalDevice physicalDevice;
   VkDevice device;
   VkSurfaceKHR surface;
+  VulkanDeletionQueue *deletionQueue = nullptr;
 
   VkSwapchainKHR swapchain = VK_NULL_HANDLE;
   std::vector<SwapChainBuffer> buffers;
@@ -23,6 +25,7 @@ private:
 
   VkFormat colorFormat;
   VkColorSpaceKHR colorSpace;
+  VkExtent2D extent = {};
 
   uint32_t imageCount;
 
@@ -41,9 +44,11 @@ public:
     swapchain = VK_NULL_HANDLE;
   }
 
-  void connect(VkPhysicalDevice physicalDevice, VkDevice device) {
+  void connect(VkPhysicalDevice physicalDevice, VkDevice device,
+               VulkanDeletionQueue *deletionQueue) {
     this->physicalDevice = physicalDevice;
     this->device = device;
+    this->deletionQueue = deletionQueue;
   }
 
   void initSurface(SDL_Window *window) {
@@ -205,6 +210,7 @@ public:
 
     VkResult result =
         vkCreateSwapchainKHR(device, &swapchainCI, nullptr, &swapchain);
+    extent = swapchainExtent;
 
     if (result != VK_SUCCESS) {
       spdlog::error("vulkan failed to create swapchain");
@@ -213,11 +219,21 @@ public:
       spdlog::debug("vulkan successfully created swapchain");
     }
 
+    // The retired swapchain and its views go once the frames still
+    // presenting from it have completed, no need to idle the device
     if (oldSwapchain != VK_NULL_HANDLE) {
+      std::vector<VkImageView> oldViews;
       for (uint32_t i = 0; i < imageCount; i++) {
-        vkDestroyImageView(device, buffers[i].view, nullptr);
+        oldViews.push_back(buffers[i].view);
       }
-      vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+
+      VkDevice logicalDevice = device;
+      deletionQueue->defer([logicalDevice, oldViews, oldSwapchain]() {
+        for (int i = 0; i < oldViews.size(); i++) {
+          vkDestroyImageView(logicalDevice, oldViews[i], nullptr);
+        }
+        vkDestroySwapchainKHR(logicalDevice, oldSwapchain, nullptr);
+      });
     }
     vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
 
@@ -262,7 +278,9 @@ public:
 
   VkFormat getImageFormat() { return colorFormat; }
 
-  std::vector<SwapChainBuffer> *getSwapChainBuffers() { return &buffers; }
+  uint32_t getImageCount() { return imageCount; }
 
-  void recreate() {}
+  VkExtent2D getExtent() { return extent; }
+
+  std::vector<SwapChainBuffer> *getSwapChainBuffers() { return &buffers; }
 };
\ No newline at end of file
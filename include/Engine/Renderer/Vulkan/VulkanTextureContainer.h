@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+// Location of one mip level inside the container it was parsed from
+struct TextureMip {
+  size_t offset;
+  size_t size;
+  uint32_t width;
+  uint32_t height;
+};
+
+// Layout of a 2D texture stored in a KTX2 or DDS file, mips ordered from the
+// base level down. Pixel data stays in the source buffer.
+struct TextureData {
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<TextureMip> mips;
+
+  bool isCompressed() const;
+};
+
+// Accepts BC1, BC3, BC5, BC7 and RGBA8 textures in either container, arrays,
+// cubemaps, volumes and supercompressed KTX2 files are rejected
+bool parseTextureContainer(const std::vector<char> &data, TextureData &texture);
+
+uint32_t getFullMipCount(uint32_t width, uint32_t height);
+size_t getMipSize(VkFormat format, uint32_t width, uint32_t height);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+#include "volk.h"
+
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Renderer/Vulkan/VulkanBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanImage.h"
+
+class VulkanTextureResource;
+
+// Default budget for streamed texture mips
+const VkDeviceSize TEXTURE_STREAMING_BUDGET = 256ull * 1024 * 1024;
+// Updates a texture can go without being requested before its extra mips are
+// released again, a couple of seconds at typical frame rates
+const uint64_t TEXTURE_REQUEST_TIMEOUT = 120;
+
+// Mip data read from disk on a job, consumed by the render thread
+struct StagedMips {
+  std::atomic<bool> ready{false};
+  bool failed = false;
+  VulkanBuffer *buffer = nullptr;
+  std::vector<VkBufferImageCopy> regions;
+
+  ~StagedMips() { delete buffer; }
+};
+
+struct StreamedTexture {
+  VulkanTextureResource *texture;
+  // Most detailed mip requested lately and the update it was requested in
+  uint32_t wantedMip;
+  uint64_t lastRequested = 0;
+
+  // In flight change of residency, staged is only set when growing
+  bool busy = false;
+  uint32_t targetMip = 0;
+  std::shared_ptr<StagedMips> staged;
+  VulkanImage *targetImage = nullptr;
+  uint64_t transferValue = 0;
+};
+
+// Moves the resident mip range of streamed textures towards what draws asked
+// for. Higher mips are read on the job system and copied in together with
+// the already resident ones into a new image, lower residency copies the
+// remaining mips into a smaller image. Textures not requested for
+// TEXTURE_REQUEST_TIMEOUT updates shrink back to the streaming base a level at
+// a time, and least recently requested textures lose mips first when the
+// resident total goes over budget.
+class VulkanTextureStreamer {
+private:
+  VulkanDevice *device;
+  VkDeviceSize budget;
+
+  std::vector<StreamedTexture> textures;
+  std::mutex mutex;
+
+  JobCounter stagingJobs{0};
+  uint64_t updateCount = 0;
+
+  void stageMips(StreamedTexture &entry);
+  void startTransfer(StreamedTexture &entry);
+  void finishTransfers();
+  void evict(VkDeviceSize &residentSize);
+
+public:
+  VulkanTextureStreamer(VulkanDevice *device,
+                        VkDeviceSize budget = TEXTURE_STREAMING_BUDGET);
+  ~VulkanTextureStreamer();
+
+  void registerTexture(VulkanTextureResource *texture);
+  void unregisterTexture(VulkanTextureResource *texture);
+
+  void setBudget(VkDeviceSize budget);
+
+  // Render thread, once per frame outside of command recording
+  void update();
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "volk.h"
+
+#include "spdlog/spdlog.h"
+
+// Binary semaphores one submission can signal along with the timeline
+const uint32_t TIMELINE_MAX_SIGNAL_SEMAPHORES = 8;
+
+// Every submission made through the timeline signals a monotonically
+// increasing value, so CPU code can wait for or poll "the GPU has reached
+// value X". Uses a VK_KHR_timeline_semaphore when the device supports it and
+// falls back to one fence per submission otherwise.
+class VulkanTimeline {
+private:
+  VkDevice device;
+  bool timelineSupported;
+
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+
+  uint64_t lastSubmittedValue = 0;
+  uint64_t completedValue = 0;
+
+  // Fallback only, fences of submissions not yet known to be complete
+  std::deque<std::pair<uint64_t, VkFence>> pendingFences;
+  std::vector<VkFence> freeFences;
+
+  std::mutex mutex;
+
+  VkFence acquireFence();
+  void retireFences(bool block, uint64_t value);
+
+public:
+  VulkanTimeline(VkDevice device, bool timelineSupported);
+  ~VulkanTimeline();
+
+  // Submits a single batch to the queue, appending the timeline signal to
+  // whatever the batch already waits on and signals. Returns the value the
+  // GPU will reach once the batch completes.
+  uint64_t submit(VkQueue queue, const VkSubmitInfo &submitInfo);
+  // Queues are externally synchronised, presenting takes the same lock as
+  // submissions made from loader threads
+  VkResult present(VkQueue queue, const VkPresentInfoKHR &presentInfo);
+
+  uint64_t getCompletedValue();
+  uint64_t getLastSubmittedValue();
+
+  bool isComplete(uint64_t value);
+  void wait(uint64_t value);
+
+  bool isTimelineSupported();
+};
\ No newline at end of file
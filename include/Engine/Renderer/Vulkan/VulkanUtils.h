@@ -1,6 +1,7 @@
 #pragma once
 
 #include "volk.h"
+#include <cstring>
 #include <optional>
 #include <set>
 #include <string>
@@ -25,6 +26,7 @@ struct SwapChainSupportDetails {
 
 bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface,
                       std::vector<const char *> deviceExtensions);
+bool checkInstanceExtensionSupport(const char *extension);
 bool checkDeviceExtensionSupport(VkPhysicalDevice device,
                                  std::vector<const char *> deviceExtensions);
 QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device,
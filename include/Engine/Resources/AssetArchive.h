@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Engine/Resources/Utils/PathHash.h"
+
+// On disk layout: ArchiveHeader, file data, then entryCount ArchiveEntry
+// records sorted by pathHash starting at tocOffset
+const char ARCHIVE_MAGIC[4] = {'T', 'P', 'A', 'K'};
+const uint32_t ARCHIVE_VERSION = 1;
+
+typedef enum {
+  ARCHIVE_COMPRESSION_NONE = 0,
+  ARCHIVE_COMPRESSION_LZ4 = 1
+} ARCHIVE_COMPRESSION;
+
+struct ArchiveHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t reserved;
+  uint64_t tocOffset;
+};
+
+struct ArchiveEntry {
+  uint64_t pathHash;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t storedSize;
+  uint32_t compression;
+  uint32_t reserved;
+};
+
+class AssetArchive {
+private:
+  const uint8_t *data = nullptr;
+  size_t dataSize = 0;
+
+  const ArchiveEntry *entries = nullptr;
+  uint32_t entryCount = 0;
+
+#ifdef _WIN32
+  std::vector<uint8_t> fileContents;
+#else
+  int fileDescriptor = -1;
+#endif
+
+  void close();
+
+public:
+  AssetArchive();
+  ~AssetArchive();
+
+  // Maps the whole archive once, every later read is served from memory
+  bool open(const std::string &path);
+
+  const ArchiveEntry *find(uint64_t pathHash);
+
+  bool contains(const std::string &path);
+  bool read(const std::string &path, std::vector<char> &contents);
+
+  uint32_t getEntryCount();
+
+  static bool
+  write(const std::string &path,
+        const std::vector<std::pair<std::string, std::vector<char>>> &files,
+        bool compress);
+};
+
+// LZ4 block format, without the frame header
+size_t lz4Compress(const uint8_t *source, size_t sourceSize,
+                   std::vector<uint8_t> &destination);
+bool lz4Decompress(const uint8_t *source, size_t sourceSize,
+                   uint8_t *destination, size_t destinationSize);
\ No newline at end of file
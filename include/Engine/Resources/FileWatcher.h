@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+// Changes arriving within this window of each other are reported together,
+// editors tend to write a file in several steps
+const int FILE_WATCHER_SETTLE_MS = 50;
+const int FILE_WATCHER_POLL_MS = 100;
+
+// Watches a directory tree with inotify and reports the paths of files that
+// were written, calling back on its own thread with paths joined onto root the
+// same way resources refer to them. Does nothing on platforms without inotify.
+class FileWatcher {
+private:
+  std::string root;
+  std::function<void(const std::vector<std::string> &)> callback;
+
+  int inotifyDescriptor = -1;
+  std::unordered_map<int, std::string> watchedDirectories;
+
+  std::atomic<bool> running{false};
+  std::thread watchThread;
+
+  void addDirectory(const std::string &path);
+  bool readEvents(int timeoutMs, std::vector<std::string> &changed);
+  void watchLoop();
+
+public:
+  FileWatcher(const std::string &root,
+              std::function<void(const std::vector<std::string> &)> callback);
+  ~FileWatcher();
+
+  bool isWatching();
+};
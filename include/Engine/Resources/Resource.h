@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include "Engine/Resources/Utils/Resource_Types.h"
@@ -9,6 +10,9 @@ private:
   int resource_id;
   RESOURCE_TYPE type;
 
+  size_t cpuSize = 0;
+  size_t gpuSize = 0;
+
   bool loaded;
 
 public:
@@ -19,4 +23,13 @@ public:
 
   void setResourceType(RESOURCE_TYPE type) { this->type = type; }
   RESOURCE_TYPE getResourceType() { return type; }
+
+  void setMemorySize(size_t cpuSize, size_t gpuSize) {
+    this->cpuSize = cpuSize;
+    this->gpuSize = gpuSize;
+  }
+  size_t getCpuSize() { return cpuSize; }
+  size_t getGpuSize() { return gpuSize; }
+
+  virtual ~Resource() {}
 };
\ No newline at end of file
@@ -9,4 +9,8 @@ class ResourceFactory {
 public:
   std::string resourceType = "none";
   virtual std::shared_ptr<Resource> load(const std::string &path) = 0;
+
+  // Whether load can run on a background thread to rebuild a resource whose
+  // files changed on disk
+  virtual bool supportsReload() { return false; }
 };
\ No newline at end of file
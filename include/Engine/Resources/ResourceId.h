@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Engine/Resources/Utils/PathHash.h"
+
+// Identifies a resource by the hash of its path, computed at compile time
+// when built from a string literal. The path is kept for loading on a cache
+// miss, for log messages and to tell colliding hashes apart.
+struct ResourceId {
+  uint64_t hash;
+  const char *path;
+
+  template <size_t N>
+  constexpr ResourceId(const char (&path)[N])
+      : hash(hashPath(path, getPathLength(path, N))), path(path) {}
+
+  constexpr ResourceId(uint64_t hash, const char *path)
+      : hash(hash), path(path) {}
+
+  constexpr bool operator==(const ResourceId &other) const {
+    return hash == other.hash && pathsEqual(path, other.path);
+  }
+};
+
+// A resource id that also carries the resource class it resolves to, so
+// lookups hand back the derived type without a cast at the call site
+template <class T> struct TypedResourceId : public ResourceId {
+  template <size_t N>
+  constexpr TypedResourceId(const char (&path)[N]) : ResourceId(path) {}
+};
@@ -1,32 +1,236 @@
 #pragma once
 
+#include <algorithm>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "SDL.h"
 #include "document.h"
 #include "spdlog/spdlog.h"
 
+#include "Engine/Resources/AssetArchive.h"
 #include "Engine/Resources/Resource.h"
 #include "Engine/Resources/ResourceFactory.h"
+#include "Engine/Resources/ResourceId.h"
+#include "Engine/Resources/ResourcePool.h"
+#include "Engine/Resources/Utils/FlatHashMap.h"
+
+// Frame boundaries a resource dropped by eviction or reload is kept alive
+// for: the frame being rendered plus the frames the simulation stage can run
+// ahead of it may still hold pointers resolved from its handles
+const uint32_t RESOURCE_RETIRE_FRAMES = 3;
+
+// Share of the device local memory budget released resources may keep
+// occupying before the least recently used ones are evicted
+const float RESOURCE_CACHE_BUDGET_FRACTION = 0.25f;
+
+struct ResourceCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+
+  size_t residentCpuBytes = 0;
+  size_t residentGpuBytes = 0;
+  size_t cachedBytes = 0;
+  size_t cacheBudget = 0;
+
+  float getHitRate() {
+    uint64_t requests = hits + misses;
+    return requests > 0 ? static_cast<float>(hits) / requests : 0.0f;
+  }
+};
+
+// Bytes held by every loaded resource of one type, cached ones included
+struct ResourceTypeStats {
+  RESOURCE_TYPE type;
+  size_t count = 0;
+  size_t cpuBytes = 0;
+  size_t gpuBytes = 0;
+};
 
 class ResourceManager {
 private:
+  // Every loaded resource is held strongly, once nothing outside the manager
+  // references it any more it counts as cached until evicted
+  struct ResourceEntry {
+    std::shared_ptr<Resource> resource;
+    // References handed out share one control block whose deleter tells the
+    // manager when the last of them is gone
+    std::weak_ptr<Resource> shared;
+    bool cached = false;
+    // Size when the resource entered the cache, what leaving it subtracts
+    size_t cachedSize = 0;
+    std::string path;
+    // Position in the recency list, moved to the back on every lookup
+    std::list<uint64_t>::iterator lruPosition;
+    // Slot in the handle pool of the resource's type while handles are out,
+    // and how to point that slot at a reloaded resource
+    uint32_t handleIndex = UINT32_MAX;
+    void (*rebindHandle)(uint32_t index,
+                         const std::shared_ptr<Resource> &resource) = nullptr;
+
+    ResourceFactory *factory = nullptr;
+    // Hashes of every file read while loading the resource
+    std::vector<uint64_t> dependencies;
+  };
+
+  struct RetiredResource {
+    std::shared_ptr<Resource> resource;
+    uint64_t frame;
+  };
+
+  struct PendingReload {
+    uint64_t hash;
+    std::shared_ptr<Resource> resource;
+    std::vector<uint64_t> dependencies;
+  };
+
   static ResourceManager *instance;
-  std::unordered_map<std::string, std::weak_ptr<Resource>> resourceMap;
-  std::unordered_map<std::string, std::unique_ptr<ResourceFactory>> factoryMap;
+  // Both maps are keyed by path hashes so lookups never build or compare
+  // strings, factories are keyed by the hash of their type name
+  FlatHashMap<ResourceEntry> resourceMap;
+  FlatHashMap<ResourceFactory *> factoryMap;
+  std::vector<std::unique_ptr<ResourceFactory>> factories;
+
+  std::recursive_mutex mutex;
+
+  AssetArchive archive;
+  bool archiveMounted = false;
+
+  std::vector<PendingReload> pendingReloads;
+
+  std::vector<RetiredResource> retiredResources;
+  uint64_t frameCount = 0;
+
+  // Hashes of every loaded resource, least recently used first
+  std::list<uint64_t> lruList;
+  size_t cacheBudget = 0;
+  ResourceCacheStats stats;
+  // Running totals over cached entries
+  size_t cachedCount = 0;
+  size_t cachedBytes = 0;
 
-  std::shared_ptr<Resource> loadResource(std::string filename);
+  ResourceEntry *findEntry(uint64_t hash, const char *path);
+  std::shared_ptr<Resource> loadResource(uint64_t hash,
+                                         const std::string &filepath);
+  // Calls the factory while recording which files it reads
+  std::shared_ptr<Resource> loadWithDependencies(
+      ResourceFactory *factory, const std::string &filepath,
+      std::vector<uint64_t> &dependencies);
+
+  // One pool per resource type, handles resolve against it without locking
+  template <class T> static ResourcePool<T> &getPool() {
+    static ResourcePool<T> pool;
+    return pool;
+  }
+
+  // Keeps the resource alive until collectRetired has run
+  // RESOURCE_RETIRE_FRAMES times
+  void retire(const std::shared_ptr<Resource> &resource);
+
+  // Outside reference to the entry's resource, takes it out of the cache
+  std::shared_ptr<Resource> share(uint64_t hash, ResourceEntry &entry);
+  // Deleter of the shared references, the entry may have been reloaded since
+  void onShareReleased(uint64_t hash, Resource *resource);
+  void enterCache(ResourceEntry &entry);
+  void leaveCache(ResourceEntry &entry);
+
+  static size_t getEntrySize(const ResourceEntry &entry);
 
 public:
   ResourceManager();
 
   void registerFactory(ResourceFactory *factory);
 
-  std::shared_ptr<Resource> getResource(std::string filepath);
+  // Serves file reads from a packed archive, paths missing from it still
+  // fall back to loose files
+  bool mountArchive(const std::string &path);
+  bool readFile(const std::string &path, std::vector<char> &contents);
+
+  std::shared_ptr<Resource> getResource(const ResourceId &id);
+  std::shared_ptr<Resource> getResource(const std::string &filepath);
+
+  // String literals hash through ResourceId rather than building a string
+  template <size_t N>
+  std::shared_ptr<Resource> getResource(const char (&filepath)[N]) {
+    return getResource(ResourceId(filepath));
+  }
+
+  template <class T> std::shared_ptr<T> getResource(const TypedResourceId<T> &id) {
+    return std::static_pointer_cast<T>(
+        getResource(static_cast<const ResourceId &>(id)));
+  }
+
   std::vector<std::shared_ptr<Resource>> getResources(RESOURCE_TYPE type);
 
+  // Handles keep their resource resident until every one acquired for it has
+  // been released, so they can be held in place of a shared_ptr
+  template <class T> ResourceHandle<T> acquire(const TypedResourceId<T> &id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    ResourceEntry *entry = findEntry(id.hash, id.path);
+    if (entry == nullptr) {
+      return ResourceHandle<T>();
+    }
+
+    ResourcePool<T> &pool = getPool<T>();
+    if (entry->handleIndex == UINT32_MAX) {
+      entry->rebindHandle = [](uint32_t index,
+                               const std::shared_ptr<Resource> &resource) {
+        getPool<T>().replace(index, std::static_pointer_cast<T>(resource));
+      };
+      entry->handleIndex = pool.insert(
+          std::static_pointer_cast<T>(share(id.hash, *entry)), id.hash);
+      if (entry->handleIndex == UINT32_MAX) {
+        spdlog::error("resource handle pool exhausted for {0}", id.path);
+        return ResourceHandle<T>();
+      }
+    }
+    return pool.retain(entry->handleIndex);
+  }
+
+  template <class T> void release(ResourceHandle<T> &handle) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    uint64_t freedKey;
+    if (getPool<T>().release(handle, freedKey)) {
+      ResourceEntry *entry = resourceMap.find(freedKey);
+      if (entry != nullptr) {
+        entry->handleIndex = UINT32_MAX;
+      }
+    }
+    handle = ResourceHandle<T>();
+  }
+
+  // Null once the handle has been released or was never valid. The pointer
+  // stays valid until RESOURCE_RETIRE_FRAMES frame boundaries after the
+  // resource is evicted or replaced by a reload, so it may be used within the
+  // frame it was resolved in but must not be kept across frames.
+  template <class T> static T *resolve(ResourceHandle<T> handle) {
+    return getPool<T>().get(handle);
+  }
+
+  // Rebuilds every reloadable resource depending on one of the files on the
+  // calling thread, the results are swapped in by applyReloads
+  void reloadChanged(const std::vector<std::string> &files);
+  // Points entries and handles at reloaded resources, called between frames
+  // so the replaced ones are only released once no recording uses them
+  void applyReloads();
+  // Frame boundary, frees resources retired RESOURCE_RETIRE_FRAMES frames ago
+  void collectRetired();
+  // Frees every retired resource, once nothing can resolve handles any more
+  void flushRetired();
+
+  void setCacheBudget(size_t bytes);
+  // Evicts least recently used released resources until the cache fits,
+  // a comparison of running totals while it does so it can run every frame
+  void trimCache();
+  ResourceCacheStats getCacheStats();
+  // One entry per type with at least one resource loaded
+  std::vector<ResourceTypeStats> getTypeStats();
+
   static ResourceManager *getInstance();
-};
+};
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+const uint32_t RESOURCE_POOL_BLOCK_SIZE = 1024;
+const uint32_t RESOURCE_POOL_MAX_BLOCKS = 64;
+
+// Index into the pool of one resource type plus the generation of the slot at
+// the time the handle was issued. Generation 0 is never issued, so a default
+// constructed handle is always invalid.
+template <class T> struct ResourceHandle {
+  uint32_t index = 0;
+  uint32_t generation = 0;
+
+  bool isValid() const { return generation != 0; }
+};
+
+// Slots for every handle issued for one resource type. Slots live in fixed
+// blocks that never move, so resolving a handle is a plain array index and a
+// generation compare without locking, even while other threads add slots.
+// Acquiring and releasing is expected to be serialised by the owner.
+template <class T> class ResourcePool {
+private:
+  struct Slot {
+    std::shared_ptr<T> resource;
+    std::atomic<T *> pointer{nullptr};
+    std::atomic<uint32_t> generation{1};
+    uint32_t references = 0;
+    uint64_t key = 0;
+  };
+
+  std::atomic<Slot *> blocks[RESOURCE_POOL_MAX_BLOCKS] = {};
+  std::atomic<uint32_t> slotCount{0};
+  std::vector<uint32_t> freeSlots;
+
+  Slot *getSlot(uint32_t index) const {
+    Slot *block = blocks[index / RESOURCE_POOL_BLOCK_SIZE].load(
+        std::memory_order_acquire);
+    return &block[index % RESOURCE_POOL_BLOCK_SIZE];
+  }
+
+public:
+  ~ResourcePool() {
+    for (uint32_t i = 0; i < RESOURCE_POOL_MAX_BLOCKS; i++) {
+      delete[] blocks[i].load();
+    }
+  }
+
+  // Takes a reference on the resource for as long as the slot is in use and
+  // returns its index, or UINT32_MAX when the pool is full
+  uint32_t insert(std::shared_ptr<T> resource, uint64_t key) {
+    uint32_t index;
+    bool appended = freeSlots.empty();
+    if (!appended) {
+      index = freeSlots.back();
+      freeSlots.pop_back();
+    } else {
+      index = slotCount.load(std::memory_order_relaxed);
+      if (index == RESOURCE_POOL_BLOCK_SIZE * RESOURCE_POOL_MAX_BLOCKS) {
+        return UINT32_MAX;
+      }
+      if (index % RESOURCE_POOL_BLOCK_SIZE == 0) {
+        blocks[index / RESOURCE_POOL_BLOCK_SIZE].store(
+            new Slot[RESOURCE_POOL_BLOCK_SIZE], std::memory_order_release);
+      }
+    }
+
+    Slot *slot = getSlot(index);
+    slot->resource = resource;
+    slot->references = 0;
+    slot->key = key;
+    slot->pointer.store(resource.get(), std::memory_order_release);
+
+    // Publish the slot only once it is fully written
+    if (appended) {
+      slotCount.store(index + 1, std::memory_order_release);
+    }
+    return index;
+  }
+
+  // Points a slot in use at a new resource, outstanding handles stay valid
+  void replace(uint32_t index, std::shared_ptr<T> resource) {
+    Slot *slot = getSlot(index);
+    slot->pointer.store(resource.get(), std::memory_order_release);
+    slot->resource = resource;
+  }
+
+  ResourceHandle<T> retain(uint32_t index) {
+    Slot *slot = getSlot(index);
+    slot->references++;
+
+    ResourceHandle<T> handle;
+    handle.index = index;
+    handle.generation = slot->generation.load(std::memory_order_relaxed);
+    return handle;
+  }
+
+  // Drops one reference, once the last one is gone the slot is recycled under
+  // a new generation and its key returned through freedKey
+  bool release(ResourceHandle<T> handle, uint64_t &freedKey) {
+    if (get(handle) == nullptr) {
+      return false;
+    }
+
+    Slot *slot = getSlot(handle.index);
+    if (--slot->references > 0) {
+      return false;
+    }
+
+    uint32_t generation = slot->generation.load(std::memory_order_relaxed) + 1;
+    slot->generation.store(generation == 0 ? 1 : generation,
+                           std::memory_order_release);
+    slot->pointer.store(nullptr, std::memory_order_release);
+    slot->resource.reset();
+    freedKey = slot->key;
+    freeSlots.push_back(handle.index);
+    return true;
+  }
+
+  T *get(ResourceHandle<T> handle) const {
+    if (!handle.isValid() ||
+        handle.index >= slotCount.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+
+    Slot *slot = getSlot(handle.index);
+    if (slot->generation.load(std::memory_order_acquire) != handle.generation) {
+      return nullptr;
+    }
+    T *pointer = slot->pointer.load(std::memory_order_acquire);
+
+    // A release and reuse of the slot between the two loads would hand out
+    // the new occupant, the generation is bumped before the pointer changes
+    // so checking it again catches that
+    if (slot->generation.load(std::memory_order_acquire) != handle.generation) {
+      return nullptr;
+    }
+    return pointer;
+  }
+};
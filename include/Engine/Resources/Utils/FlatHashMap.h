@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open addressing map from precomputed 64 bit hashes to values, probing
+// linearly through one contiguous slot array so lookups touch a single cache
+// line in the common case. Keys are expected to already be well mixed hashes.
+template <class V> class FlatHashMap {
+private:
+  enum SLOT_STATE : uint8_t { SLOT_EMPTY = 0, SLOT_FULL = 1, SLOT_ERASED = 2 };
+
+  struct Slot {
+    uint64_t key = 0;
+    SLOT_STATE state = SLOT_EMPTY;
+    V value = V();
+  };
+
+  std::vector<Slot> slots;
+  size_t count = 0;
+  size_t erased = 0;
+
+  size_t mask() const { return slots.size() - 1; }
+
+  // Keeps full and erased slots under three quarters of the table so probe
+  // sequences stay short, growing only when live entries need the room
+  void reserveSlot() {
+    if (!slots.empty() && (count + erased + 1) * 4 <= slots.size() * 3) {
+      return;
+    }
+
+    size_t capacity = slots.empty() ? 16 : slots.size();
+    while ((count + 1) * 2 > capacity) {
+      capacity *= 2;
+    }
+
+    std::vector<Slot> old = std::move(slots);
+    slots = std::vector<Slot>(capacity);
+    count = 0;
+    erased = 0;
+
+    for (size_t i = 0; i < old.size(); i++) {
+      if (old[i].state == SLOT_FULL) {
+        insert(old[i].key) = std::move(old[i].value);
+      }
+    }
+  }
+
+  // Index of the slot holding key, or the table size when it is absent
+  size_t findSlot(uint64_t key) const {
+    if (slots.empty()) {
+      return 0;
+    }
+
+    for (size_t i = key & mask();; i = (i + 1) & mask()) {
+      const Slot &slot = slots[i];
+      if (slot.state == SLOT_EMPTY) {
+        return slots.size();
+      }
+      if (slot.state == SLOT_FULL && slot.key == key) {
+        return i;
+      }
+    }
+  }
+
+public:
+  V *find(uint64_t key) {
+    size_t index = findSlot(key);
+    return index < slots.size() ? &slots[index].value : nullptr;
+  }
+
+  // Returns the value stored under key, default constructing it if absent
+  V &insert(uint64_t key) {
+    V *existing = find(key);
+    if (existing != nullptr) {
+      return *existing;
+    }
+
+    reserveSlot();
+
+    for (size_t i = key & mask();; i = (i + 1) & mask()) {
+      Slot &slot = slots[i];
+      if (slot.state != SLOT_FULL) {
+        if (slot.state == SLOT_ERASED) {
+          erased--;
+        }
+        slot.key = key;
+        slot.state = SLOT_FULL;
+        slot.value = V();
+        count++;
+        return slot.value;
+      }
+    }
+  }
+
+  bool erase(uint64_t key) {
+    size_t index = findSlot(key);
+    if (index >= slots.size()) {
+      return false;
+    }
+
+    slots[index].state = SLOT_ERASED;
+    slots[index].value = V();
+    count--;
+    erased++;
+    return true;
+  }
+
+  template <class F> void forEach(F function) {
+    for (size_t i = 0; i < slots.size(); i++) {
+      if (slots[i].state == SLOT_FULL) {
+        function(slots[i].key, slots[i].value);
+      }
+    }
+  }
+
+  size_t size() const { return count; }
+};
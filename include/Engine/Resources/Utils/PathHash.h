@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64 bit FNV-1a over the bytes of a resource path
+constexpr uint64_t hashPath(const char *path, size_t length) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(path[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Length of a path stored in a char array, up to its first NUL so arrays
+// with room to spare hash like the string they hold
+constexpr size_t getPathLength(const char *path, size_t capacity) {
+  size_t length = 0;
+  while (length < capacity && path[length] != '\0') {
+    length++;
+  }
+  return length;
+}
+
+constexpr bool pathsEqual(const char *a, const char *b) {
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  while (*a != '\0' && *a == *b) {
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+inline uint64_t hashPath(const std::string &path) {
+  return hashPath(path.data(), path.size());
+}
+
+// Same hash over arbitrary bytes, for keys built from plain structs
+inline uint64_t hashBytes(const void *data, size_t size) {
+  return hashPath(static_cast<const char *>(data), size);
+}
@@ -7,5 +7,30 @@ typedef enum {
   RESOURCE_TEXTURE = 3,
   RESOURCE_VULKAN_MESH = 4,
   RESOURCE_VULKAN_MESH_INSTANCE = 5,
-  RESOURCE_VULKAN_PIPELINE = 6
-} RESOURCE_TYPE;
\ No newline at end of file
+  RESOURCE_VULKAN_PIPELINE = 6,
+  RESOURCE_VULKAN_TEXTURE = 7,
+  RESOURCE_VULKAN_COMPUTE_PIPELINE = 8
+} RESOURCE_TYPE;
+
+inline const char *getResourceTypeName(RESOURCE_TYPE type) {
+  switch (type) {
+  case RESOURCE_SHADER:
+    return "shader";
+  case RESOURCE_MESH:
+    return "mesh";
+  case RESOURCE_TEXTURE:
+    return "texture";
+  case RESOURCE_VULKAN_MESH:
+    return "vulkan_mesh";
+  case RESOURCE_VULKAN_MESH_INSTANCE:
+    return "vulkan_mesh_instance";
+  case RESOURCE_VULKAN_PIPELINE:
+    return "vulkan_pipeline";
+  case RESOURCE_VULKAN_TEXTURE:
+    return "vulkan_texture";
+  case RESOURCE_VULKAN_COMPUTE_PIPELINE:
+    return "vulkan_compute_pipeline";
+  default:
+    return "null";
+  }
+}
\ No newline at end of file
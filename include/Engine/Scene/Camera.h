@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+#include "spdlog/spdlog.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Camera component, the scene renders from the entity set as active camera
+class Camera {
+private:
+  glm::vec3 eye = glm::vec3(2.0f, 2.0f, 2.0f);
+  glm::vec3 target = glm::vec3(0.0f, 0.0f, 0.0f);
+  glm::vec3 up = glm::vec3(0.0f, 0.0f, 1.0f);
+
+  float fov = glm::radians(45.0f);
+  float nearPlane = 0.1f;
+  float farPlane = 10.0f;
+
+  uint32_t width = 1;
+  uint32_t height = 1;
+
+  glm::mat4 view = glm::mat4(1.0f);
+  glm::mat4 projection = glm::mat4(1.0f);
+  glm::mat4 viewProjection = glm::mat4(1.0f);
+
+  void updateView();
+  void updateProjection();
+
+public:
+  Camera(uint32_t width, uint32_t height);
+  ~Camera();
+
+  void lookAt(glm::vec3 eye, glm::vec3 target, glm::vec3 up);
+  void setPerspective(float fov, float nearPlane, float farPlane);
+
+  // Called with the current swapchain extent, only rebuilds the projection
+  // when the extent actually changed
+  void setExtent(uint32_t width, uint32_t height);
+
+  const glm::mat4 &getView();
+  const glm::mat4 &getProjection();
+  const glm::mat4 &getViewProjection();
+
+  // Approximate height in pixels of a sphere at the given world position
+  float getProjectedSize(glm::vec3 position, float radius);
+};
\ No newline at end of file
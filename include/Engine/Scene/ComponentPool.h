@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Engine/Scene/Entity.h"
+
+const uint32_t COMPONENT_SLOT_NONE = 0xFFFFFFFF;
+
+class ComponentPoolBase {
+public:
+  virtual ~ComponentPoolBase() {}
+
+  virtual void remove(Entity entity) = 0;
+  virtual bool has(Entity entity) const = 0;
+  virtual uint32_t size() const = 0;
+};
+
+// Sparse set of one component type. Components are packed in a dense array
+// in no particular order, with the owning entity at the same position, so
+// systems walk contiguous memory. The sparse array maps entity indices to
+// dense slots for lookups. Removal moves the last component into the hole.
+template <class T> class ComponentPool : public ComponentPoolBase {
+private:
+  std::vector<uint32_t> sparse;
+  std::vector<Entity> entities;
+  std::vector<T> components;
+
+  uint32_t findSlot(Entity entity) const {
+    uint32_t index = getEntityIndex(entity);
+    if (index >= sparse.size()) {
+      return COMPONENT_SLOT_NONE;
+    }
+
+    uint32_t slot = sparse[index];
+    // A stale entity of the same index fails the full id compare
+    if (slot == COMPONENT_SLOT_NONE || entities[slot] != entity) {
+      return COMPONENT_SLOT_NONE;
+    }
+    return slot;
+  }
+
+public:
+  // Replaces the component when the entity already has one
+  T &add(Entity entity, const T &component) {
+    uint32_t slot = findSlot(entity);
+    if (slot != COMPONENT_SLOT_NONE) {
+      components[slot] = component;
+      return components[slot];
+    }
+
+    uint32_t index = getEntityIndex(entity);
+    if (index >= sparse.size()) {
+      sparse.resize(index + 1, COMPONENT_SLOT_NONE);
+    }
+
+    sparse[index] = static_cast<uint32_t>(components.size());
+    entities.push_back(entity);
+    components.push_back(component);
+    return components.back();
+  }
+
+  void remove(Entity entity) override {
+    uint32_t slot = findSlot(entity);
+    if (slot == COMPONENT_SLOT_NONE) {
+      return;
+    }
+
+    uint32_t last = static_cast<uint32_t>(components.size()) - 1;
+    if (slot != last) {
+      components[slot] = std::move(components[last]);
+      entities[slot] = entities[last];
+      sparse[getEntityIndex(entities[slot])] = slot;
+    }
+
+    components.pop_back();
+    entities.pop_back();
+    sparse[getEntityIndex(entity)] = COMPONENT_SLOT_NONE;
+  }
+
+  bool has(Entity entity) const override {
+    return findSlot(entity) != COMPONENT_SLOT_NONE;
+  }
+
+  // Valid until the next add or remove on this pool
+  T *get(Entity entity) {
+    uint32_t slot = findSlot(entity);
+    return slot != COMPONENT_SLOT_NONE ? &components[slot] : nullptr;
+  }
+
+  uint32_t size() const override {
+    return static_cast<uint32_t>(components.size());
+  }
+
+  // Dense spans, the entity at position i owns the component at position i
+  T *data() { return components.data(); }
+  const Entity *getEntities() const { return entities.data(); }
+};
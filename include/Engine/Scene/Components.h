@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanMeshInstanceResource.h"
+#include "Engine/Resources/ResourceManager.h"
+
+// Components are plain data kept densely by the registry, the behaviour
+// lives in the systems Scene::update runs over them
+
+struct Transform {
+  glm::vec3 translation = glm::vec3(0.0f);
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 scale = glm::vec3(1.0f);
+  // Rebuilt from the fields above every update
+  glm::mat4 model = glm::mat4(1.0f);
+};
+
+struct MeshRenderer {
+  // Released by the scene when the entity is destroyed
+  ResourceHandle<VulkanMeshInstanceResource> meshInstance;
+};
+
+// Model space bounding sphere, xyz center and w radius
+struct Bounds {
+  glm::vec4 sphere = glm::vec4(0.0f, 0.0f, 0.0f, 0.5f);
+};
+
+// Constant rotation about an axis, what actors used to do in Actor::update
+struct Spin {
+  glm::vec3 axis = glm::vec3(0.0f, 0.0f, 1.0f);
+  float radiansPerSecond = 0.0f;
+};
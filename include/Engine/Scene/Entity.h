@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Index into the component pools in the low bits plus the generation of that
+// index in the high bits. An index whose generation would wrap is retired, so
+// no two entities ever share an id.
+typedef uint32_t Entity;
+
+const uint32_t ENTITY_INDEX_BITS = 24;
+const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const uint32_t ENTITY_MAX_GENERATION = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
+const Entity NULL_ENTITY = 0xFFFFFFFF;
+
+inline uint32_t getEntityIndex(Entity entity) {
+  return entity & ENTITY_INDEX_MASK;
+}
+
+inline uint32_t getEntityGeneration(Entity entity) {
+  return entity >> ENTITY_INDEX_BITS;
+}
+
+inline Entity makeEntity(uint32_t index, uint32_t generation) {
+  return (generation << ENTITY_INDEX_BITS) | index;
+}
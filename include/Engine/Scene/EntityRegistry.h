@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "Engine/Scene/ComponentPool.h"
+#include "Engine/Scene/Entity.h"
+
+// Creates entities and owns one component pool per component type. Pools are
+// created on first use, so the owner creates them up front when systems look
+// them up from several threads.
+class EntityRegistry {
+private:
+  // Current generation of every index handed out
+  std::vector<uint32_t> generations;
+  std::vector<uint32_t> freeIndices;
+  uint32_t entityCount = 0;
+
+  // Indexed by component type id
+  std::vector<ComponentPoolBase *> pools;
+
+  static uint32_t nextComponentTypeId();
+
+  template <class T> static uint32_t getComponentTypeId() {
+    static uint32_t id = nextComponentTypeId();
+    return id;
+  }
+
+public:
+  ~EntityRegistry();
+
+  Entity create();
+  // Removes every component of the entity
+  void destroy(Entity entity);
+  bool isAlive(Entity entity) const;
+  uint32_t getEntityCount() const;
+
+  template <class T> ComponentPool<T> &getPool() {
+    uint32_t id = getComponentTypeId<T>();
+    if (id >= pools.size()) {
+      pools.resize(id + 1, nullptr);
+    }
+    if (pools[id] == nullptr) {
+      pools[id] = new ComponentPool<T>();
+    }
+    return *static_cast<ComponentPool<T> *>(pools[id]);
+  }
+
+  template <class T> T &add(Entity entity, const T &component = T()) {
+    return getPool<T>().add(entity, component);
+  }
+
+  template <class T> void remove(Entity entity) { getPool<T>().remove(entity); }
+
+  template <class T> bool has(Entity entity) { return getPool<T>().has(entity); }
+
+  template <class T> T *get(Entity entity) { return getPool<T>().get(entity); }
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Engine/Resources/ResourcePool.h"
+
+class VulkanMeshInstanceResource;
+
+struct MeshDraw {
+  // Resolved by the render stage, an instance released after the snapshot
+  // was taken resolves to null there and draws nothing
+  ResourceHandle<VulkanMeshInstanceResource> meshInstance;
+  glm::mat4 model;
+};
+
+// Copy of everything the render stage needs from the scene, so simulation of
+// the next frame can mutate nodes while this one is being recorded
+struct RenderSnapshot {
+  uint64_t frameNumber = 0;
+  glm::mat4 viewProjection = glm::mat4(1.0f);
+  std::vector<MeshDraw> meshDraws;
+  // Indices of the draws whose mesh instance or model differ from the
+  // previous snapshot, in no particular order. Draws past the previous
+  // snapshot's count are new either way. Only the first changedDrawCount
+  // entries are set, the vector keeps one slot per draw as storage.
+  std::vector<uint32_t> changedDraws;
+  uint32_t changedDrawCount = 0;
+};
\ No newline at end of file
@@ -1,16 +1,55 @@
 #pragma once
 
-#include "Engine/Scene/Node.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "Engine/Scene/Camera.h"
+#include "Engine/Scene/Components.h"
+#include "Engine/Scene/EntityRegistry.h"
+#include "Engine/Scene/RenderSnapshot.h"
+
+#include "Engine/Jobs/JobSystem.h"
+
+// Components handed to a single job by Scene::update and draw list generation
+const uint32_t SCENE_JOB_GRAIN_SIZE = 256;
 
 class Scene {
 private:
-  std::vector<Node*> nodeList;
+  EntityRegistry registry;
+  Entity activeCamera = NULL_ENTITY;
+
+  std::chrono::high_resolution_clock::time_point startTime;
+
+  // Rebuilt in place every frame so its storage is only grown, never freed
+  std::vector<Entity> drawList;
+  // Draws of the last snapshot built, what the next one is compared against
+  // to find the changed draws
+  std::vector<MeshDraw> publishedDraws;
+  std::atomic<uint32_t> changedDrawCount{0};
+
+  void updateSpin(float time);
+  void updateTransforms();
 public:
+  Scene();
   ~Scene();
-  
-  void addNode(Node* node);
 
-  std::vector<Node*> getMeshDrawList();
+  // An entity drawn with the mesh instance, which it takes the handle over
+  // for. Bounds come from the mesh when it is loaded already.
+  Entity createActor(ResourceHandle<VulkanMeshInstanceResource> meshInstance);
+  Entity createCamera(uint32_t width, uint32_t height);
+  void destroyEntity(Entity entity);
+
+  EntityRegistry& getRegistry();
+
+  void setActiveCamera(Entity camera);
+  Camera* getActiveCamera();
+
+  // Entities with a mesh renderer and a transform, in pool order. Valid until
+  // the next call.
+  const std::vector<Entity>& getMeshDrawList();
+
+  void buildSnapshot(RenderSnapshot& snapshot);
 
   void update();
-};
\ No newline at end of file
+};
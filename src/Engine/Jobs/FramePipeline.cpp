@@ -0,0 +1,60 @@
+#include "Engine/Jobs/FramePipeline.h"
+
+FramePipeline::FramePipeline(uint32_t depth,
+                             std::function<void(RenderSnapshot &)> simulate) {
+  this->snapshots.resize(depth > 1 ? depth : 2);
+  this->simulate = simulate;
+
+  spdlog::debug("frame pipeline started with depth {0}", snapshots.size());
+
+  simulationThread = std::thread(&FramePipeline::simulationLoop, this);
+}
+
+FramePipeline::~FramePipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+  }
+  condition.notify_all();
+  simulationThread.join();
+}
+
+void FramePipeline::simulationLoop() {
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] {
+      return !running || simulatedFrames - renderedFrames < snapshots.size();
+    });
+
+    if (!running) {
+      return;
+    }
+
+    RenderSnapshot &snapshot = snapshots[simulatedFrames % snapshots.size()];
+    snapshot.frameNumber = simulatedFrames;
+    lock.unlock();
+
+    simulate(snapshot);
+
+    lock.lock();
+    simulatedFrames++;
+    lock.unlock();
+    condition.notify_all();
+  }
+}
+
+void FramePipeline::renderFrame(
+    const std::function<void(const RenderSnapshot &)> &render) {
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this] { return simulatedFrames > renderedFrames; });
+
+  const RenderSnapshot &snapshot = snapshots[renderedFrames % snapshots.size()];
+  lock.unlock();
+
+  render(snapshot);
+
+  lock.lock();
+  renderedFrames++;
+  lock.unlock();
+  condition.notify_all();
+}
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "Engine/Jobs/JobSystem.h"
+
+JobSystem *JobSystem::instance = 0;
+
+// Index of the worker owning the current thread, -1 for threads outside the
+// pool such as the main thread
+static thread_local int32_t currentWorker = -1;
+
+JobQueue::JobQueue() { jobs.resize(JOB_QUEUE_CAPACITY); }
+
+bool JobQueue::push(Job &job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (count == JOB_QUEUE_CAPACITY) {
+    return false;
+  }
+  jobs[(head + count) % JOB_QUEUE_CAPACITY] = std::move(job);
+  count++;
+  return true;
+}
+
+bool JobQueue::pop(Job &job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (count == 0) {
+    return false;
+  }
+  count--;
+  Job &slot = jobs[(head + count) % JOB_QUEUE_CAPACITY];
+  job = std::move(slot);
+  // Releases whatever the function captured now rather than on reuse
+  slot.function = nullptr;
+  return true;
+}
+
+bool JobQueue::steal(Job &job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (count == 0) {
+    return false;
+  }
+  Job &slot = jobs[head];
+  job = std::move(slot);
+  slot.function = nullptr;
+  head = (head + 1) % JOB_QUEUE_CAPACITY;
+  count--;
+  return true;
+}
+
+JobSystem::JobSystem(uint32_t workerCount) {
+  uint32_t queueCount = workerCount > 0 ? workerCount : 1;
+  for (uint32_t i = 0; i < queueCount; i++) {
+    queues.push_back(new JobQueue());
+  }
+
+  for (uint32_t i = 0; i < workerCount; i++) {
+    workers.emplace_back(&JobSystem::workerLoop, this, i);
+  }
+
+  spdlog::debug("job system started with {0} workers", workerCount);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    running = false;
+  }
+  sleepCondition.notify_all();
+
+  for (int i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+
+  for (int i = 0; i < queues.size(); i++) {
+    delete queues[i];
+  }
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex) {
+  currentWorker = static_cast<int32_t>(workerIndex);
+
+  while (running) {
+    Job job;
+    if (findJob(workerIndex, job)) {
+      execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    sleepCondition.wait(lock, [this] { return queuedJobs > 0 || !running; });
+  }
+}
+
+bool JobSystem::findJob(uint32_t queueIndex, Job &job) {
+  uint32_t queueCount = static_cast<uint32_t>(queues.size());
+
+  if (currentWorker >= 0 && queues[queueIndex]->pop(job)) {
+    queuedJobs--;
+    return true;
+  }
+
+  for (uint32_t i = 1; i <= queueCount; i++) {
+    if (queues[(queueIndex + i) % queueCount]->steal(job)) {
+      queuedJobs--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool JobSystem::push(Job &job) {
+  uint32_t queueCount = static_cast<uint32_t>(queues.size());
+  uint32_t queueIndex = currentWorker >= 0
+                            ? static_cast<uint32_t>(currentWorker)
+                            : nextQueue++ % queueCount;
+
+  bool queued = false;
+  for (uint32_t i = 0; i < queueCount && !queued; i++) {
+    queued = queues[(queueIndex + i) % queueCount]->push(job);
+  }
+  if (!queued) {
+    return false;
+  }
+  queuedJobs++;
+
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+  }
+  sleepCondition.notify_one();
+  return true;
+}
+
+void JobSystem::execute(Job &job) {
+  job.function();
+
+  if (job.counter != nullptr) {
+    complete(job.counter);
+  }
+}
+
+void JobSystem::complete(JobCounter *counter) {
+  std::vector<Job> ready;
+  {
+    // Nothing touches the counter after this lock is released, the thread
+    // waiting on it may destroy it as soon as it sees zero
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    if (--counter->value > 0) {
+      return;
+    }
+    ready.swap(counter->dependents);
+  }
+
+  for (int i = 0; i < ready.size(); i++) {
+    if (!push(ready[i])) {
+      execute(ready[i]);
+    }
+  }
+
+  // Wakes threads blocked in wait on this counter
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+  }
+  sleepCondition.notify_all();
+}
+
+void JobSystem::run(std::function<void()> function, JobCounter *counter,
+                    JobCounter *dependency) {
+  Job job;
+  job.function = std::move(function);
+  job.counter = counter;
+
+  if (counter != nullptr) {
+    counter->value++;
+  }
+
+  if (dependency != nullptr) {
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (dependency->value > 0) {
+      dependency->dependents.push_back(std::move(job));
+      return;
+    }
+  }
+
+  // Every queue is full, the caller does the work instead of waiting on it
+  if (!push(job)) {
+    execute(job);
+  }
+}
+
+void JobSystem::parallelFor(
+    uint32_t count, uint32_t grainSize,
+    const std::function<void(uint32_t, uint32_t)> &function) {
+  if (grainSize == 0) {
+    grainSize = 1;
+  }
+
+  if (count <= grainSize || workers.empty()) {
+    function(0, count);
+    return;
+  }
+
+  JobCounter counter{0};
+  for (uint32_t begin = 0; begin < count; begin += grainSize) {
+    uint32_t end = std::min(begin + grainSize, count);
+    run([&function, begin, end] { function(begin, end); }, &counter);
+  }
+
+  wait(&counter);
+}
+
+void JobSystem::wait(JobCounter *counter) {
+  uint32_t queueIndex = currentWorker >= 0
+                            ? static_cast<uint32_t>(currentWorker)
+                            : 0;
+
+  while (counter->value > 0) {
+    Job job;
+    if (findJob(queueIndex, job)) {
+      execute(job);
+      continue;
+    }
+
+    // The jobs left are running on other threads
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    sleepCondition.wait(lock, [this, counter] {
+      return counter->value == 0 || queuedJobs > 0;
+    });
+  }
+
+  // Returns only once the thread that brought the counter to zero is done
+  // with it
+  std::lock_guard<std::mutex> lock(counter->mutex);
+}
+
+uint32_t JobSystem::getWorkerCount() {
+  return static_cast<uint32_t>(workers.size());
+}
+
+JobSystem *JobSystem::getInstance() {
+  if (instance == 0) {
+    uint32_t threadCount = std::thread::hardware_concurrency();
+    instance = new JobSystem(threadCount > 1 ? threadCount - 1 : 0);
+  }
+  return instance;
+}
\ No newline at end of file
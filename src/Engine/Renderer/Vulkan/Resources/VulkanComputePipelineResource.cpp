@@ -0,0 +1,88 @@
+#include "Engine/Renderer/Vulkan/Resources/VulkanComputePipelineResource.h"
+
+VulkanComputePipelineResource::~VulkanComputePipelineResource() {
+  spdlog::debug("destroying compute pipeline");
+
+  // Layouts belong to the device's layout cache and outlive the pipeline
+  VkDevice logicalDevice = device->getDevice();
+  VkPipeline pipeline = this->pipeline;
+  VkShaderModule shaderModule = this->shaderModule;
+  device->getDeletionQueue()->defer([logicalDevice, pipeline, shaderModule]() {
+    vkDestroyPipeline(logicalDevice, pipeline, nullptr);
+    vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
+  });
+}
+
+void VulkanComputePipelineResource::createLayouts(
+    const ShaderReflection &reflection) {
+  VulkanPipelineLayoutCache *layoutCache = device->getLayoutCache();
+  descriptorLayouts = layoutCache->getDescriptorSetLayouts(reflection);
+
+  std::vector<VkPushConstantRange> pushConstantRanges;
+  if (reflection.pushConstantSize > 0) {
+    pushConstantRange.stageFlags = reflection.pushConstantStages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = reflection.pushConstantSize;
+    pushConstantRanges.push_back(pushConstantRange);
+  }
+
+  pipelineLayout =
+      layoutCache->getPipelineLayout(descriptorLayouts, pushConstantRanges);
+}
+
+void VulkanComputePipelineResource::load(const std::vector<char> &computeCode) {
+  ShaderReflection reflection;
+  if (!reflectShader(computeCode, reflection) ||
+      !(reflection.stageFlags & VK_SHADER_STAGE_COMPUTE_BIT)) {
+    spdlog::error("failed to reflect compute shader");
+    return;
+  }
+  createLayouts(reflection);
+
+  VkShaderModuleCreateInfo moduleInfo = {};
+  moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  moduleInfo.codeSize = computeCode.size();
+  moduleInfo.pCode = reinterpret_cast<const uint32_t *>(computeCode.data());
+
+  if (vkCreateShaderModule(device->getDevice(), &moduleInfo, nullptr,
+                           &shaderModule) != VK_SUCCESS) {
+    spdlog::error("failed to compile compute shader module");
+    return;
+  }
+
+  setMemorySize(computeCode.size(), 0);
+
+  VkComputePipelineCreateInfo pipelineInfo = {};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = shaderModule;
+  pipelineInfo.stage.pName = "main";
+  pipelineInfo.layout = pipelineLayout;
+
+  if (vkCreateComputePipelines(device->getDevice(), device->getPipelineCache(),
+                               1, &pipelineInfo, nullptr,
+                               &pipeline) != VK_SUCCESS) {
+    spdlog::error("error creating compute pipeline");
+    pipeline = VK_NULL_HANDLE;
+    return;
+  }
+
+  spdlog::debug("created compute pipeline");
+}
+
+VkPipeline VulkanComputePipelineResource::getPipeline() { return pipeline; }
+
+VkPipelineLayout VulkanComputePipelineResource::getPipelineLayout() {
+  return pipelineLayout;
+}
+
+VkDescriptorSetLayout
+VulkanComputePipelineResource::getDescriptorSetLayout(uint32_t set) {
+  return set < descriptorLayouts.size() ? descriptorLayouts[set]
+                                        : VK_NULL_HANDLE;
+}
+
+VkPushConstantRange VulkanComputePipelineResource::getPushConstantRange() {
+  return pushConstantRange;
+}
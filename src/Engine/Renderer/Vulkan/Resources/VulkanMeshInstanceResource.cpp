@@ -1,10 +1,12 @@
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshInstanceResource.h"
 
-VulkanMeshInstanceResource::VulkanMeshInstanceResource(VulkanDevice* device, int descriptorIndex, std::shared_ptr<VulkanMeshResource> mesh)
+VulkanMeshInstanceResource::VulkanMeshInstanceResource(VulkanDevice* device, int descriptorIndex, std::shared_ptr<VulkanMeshResource> mesh, std::shared_ptr<VulkanTextureResource> texture)
 {
   this->mesh = mesh;
+  this->texture = texture;
   this->descriptorIndex = descriptorIndex;
   this->device = device;
+  setMemorySize(sizeof(VulkanMeshInstanceResource), 0);
 }
 
 VulkanMeshInstanceResource::~VulkanMeshInstanceResource()
@@ -17,8 +19,12 @@ void VulkanMeshInstanceResource::update(UniformBufferObject ubo)
 
 }
 
-std::shared_ptr<VulkanMeshResource> VulkanMeshInstanceResource::getMesh() {
-  return mesh;
+VulkanMeshResource *VulkanMeshInstanceResource::getMesh() {
+  return mesh.get();
+}
+
+VulkanTextureResource *VulkanMeshInstanceResource::getTexture() {
+  return texture.get();
 }
 
 int VulkanMeshInstanceResource::getDescriptorIndex()
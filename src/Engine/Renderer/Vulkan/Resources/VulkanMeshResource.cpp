@@ -3,6 +3,7 @@
 VulkanMeshResource::VulkanMeshResource(VulkanDevice *device) {
   this->device = device;
   loadBuffers();
+  computeBounds();
 }
 
 VulkanMeshResource::~VulkanMeshResource() {
@@ -16,33 +17,46 @@ void VulkanMeshResource::loadBuffers() {
 
   VulkanBuffer vertexStagingBuffer(device, vertexBufferSize,
                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                   VMA_MEMORY_USAGE_CPU_ONLY);
+                                   VMA_MEMORY_USAGE_CPU_ONLY,
+                                   VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                                   MEMORY_POOL_STAGING);
   vertexStagingBuffer.update(reinterpret_cast<const void *>(vertices.data()),
                              vertexBufferSize, 0);
 
   VulkanBuffer *vertexDeviceBuffer = new VulkanBuffer(
       device, vertexBufferSize,
       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VMA_MEMORY_USAGE_GPU_ONLY);
+      VMA_MEMORY_USAGE_GPU_ONLY, 0, MEMORY_POOL_MESH);
 
-  vertexDeviceBuffer->transferDataFrom(&vertexStagingBuffer);
+  // Freed when the copy completes rather than waited on here
+  vertexStagingBuffer.retireAt(
+      vertexDeviceBuffer->transferDataFrom(&vertexStagingBuffer));
+  // Bound by handle at draw time, nothing to patch when it moves
+  vertexDeviceBuffer->setRelocatable();
 
   this->vertexBuffer = vertexDeviceBuffer;
 
   VulkanBuffer indexStagingBuffer(device, indexBufferSize,
                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                  VMA_MEMORY_USAGE_CPU_ONLY);
+                                  VMA_MEMORY_USAGE_CPU_ONLY,
+                                  VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                                  MEMORY_POOL_STAGING);
   indexStagingBuffer.update(reinterpret_cast<const void *>(indices.data()),
                             indexBufferSize, 0);
 
   VulkanBuffer *indexDeviceBuffer = new VulkanBuffer(
       device, indexBufferSize,
       VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VMA_MEMORY_USAGE_GPU_ONLY);
+      VMA_MEMORY_USAGE_GPU_ONLY, 0, MEMORY_POOL_MESH);
 
-  indexDeviceBuffer->transferDataFrom(&indexStagingBuffer);
+  indexStagingBuffer.retireAt(
+      indexDeviceBuffer->transferDataFrom(&indexStagingBuffer));
+  indexDeviceBuffer->setRelocatable();
 
   this->indexBuffer = indexDeviceBuffer;
+
+  setMemorySize(0, static_cast<size_t>(vertexBuffer->getAllocationSize() +
+                                       indexBuffer->getAllocationSize()));
 }
 
 VkBuffer VulkanMeshResource::getVertexBuffer() {
@@ -53,4 +67,23 @@ VkBuffer VulkanMeshResource::getIndexBuffer() {
   return indexBuffer->getBuffer();
 }
 
-int VulkanMeshResource::getIndexCount() { return indices.size(); }
\ No newline at end of file
+int VulkanMeshResource::getIndexCount() { return indices.size(); }
+
+void VulkanMeshResource::computeBounds() {
+  glm::vec2 minimum = vertices[0].pos;
+  glm::vec2 maximum = vertices[0].pos;
+  for (int i = 1; i < vertices.size(); i++) {
+    minimum = glm::min(minimum, vertices[i].pos);
+    maximum = glm::max(maximum, vertices[i].pos);
+  }
+
+  // Centered on the box, slightly looser than the tightest sphere
+  glm::vec2 center = (minimum + maximum) * 0.5f;
+  float radius = 0.0f;
+  for (int i = 0; i < vertices.size(); i++) {
+    radius = glm::max(radius, glm::length(vertices[i].pos - center));
+  }
+  bounds = glm::vec4(center, 0.0f, radius);
+}
+
+glm::vec4 VulkanMeshResource::getBounds() { return bounds; }
@@ -1,5 +1,7 @@
 #include "Engine/Renderer/Vulkan/Resources/VulkanPipelineResource.h"
 
+#include "Engine/Jobs/JobSystem.h"
+
 #define VMA_IMPLEMENTATION
 #include "vk_mem_alloc.h"
 
@@ -20,56 +22,204 @@ VulkanPipelineResource::createShaderModule(const std::vector<char> &code) {
   return shaderModule;
 }
 
-void VulkanPipelineResource::createDescriptorSetLayout() {
-  VkDescriptorSetLayoutBinding descriptorLayoutBinding = {};
-  descriptorLayoutBinding.binding = 0;
-  descriptorLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-  descriptorLayoutBinding.descriptorCount = 1;
-  descriptorLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+bool VulkanPipelineResource::createLayouts(
+    const std::vector<char> &vertexCode,
+    const std::vector<char> &fragmentCode) {
+  ShaderReflection reflection;
+  ShaderReflection fragmentReflection;
+  if (!reflectShader(vertexCode, reflection) ||
+      !reflectShader(fragmentCode, fragmentReflection)) {
+    spdlog::error("failed to reflect pipeline shaders");
+    return false;
+  }
+  reflection.merge(fragmentReflection);
+
+  checkVertexInputs(reflection);
 
-  VkDescriptorSetLayoutCreateInfo createInfo = {};
-  createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-  createInfo.bindingCount = 1;
-  createInfo.pBindings = &descriptorLayoutBinding;
+  VulkanPipelineLayoutCache *layoutCache = device->getLayoutCache();
+  descriptorLayouts = layoutCache->getDescriptorSetLayouts(reflection);
 
-  if (vkCreateDescriptorSetLayout(device->getDevice(), &createInfo, nullptr, &descriptorLayout) != VK_SUCCESS) {
-    spdlog::error("failed to create vulkan descriptor set layout");
-  } else {
-    spdlog::debug("created vulkan descriptor set layout");
+  std::vector<VkPushConstantRange> pushConstantRanges;
+  if (reflection.pushConstantSize > 0) {
+    pushConstantRange.stageFlags = reflection.pushConstantStages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = reflection.pushConstantSize;
+    pushConstantRanges.push_back(pushConstantRange);
+  }
+
+  pipelineLayout =
+      layoutCache->getPipelineLayout(descriptorLayouts, pushConstantRanges);
+  return pipelineLayout != VK_NULL_HANDLE;
+}
+
+void VulkanPipelineResource::checkVertexInputs(
+    const ShaderReflection &reflection) {
+  auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+  for (int i = 0; i < reflection.inputs.size(); i++) {
+    const ShaderInput &input = reflection.inputs[i];
+    bool matched = false;
+    for (int j = 0; j < attributeDescriptions.size(); j++) {
+      if (attributeDescriptions[j].location == input.location &&
+          attributeDescriptions[j].format == input.format) {
+        matched = true;
+      }
+    }
+
+    if (!matched) {
+      spdlog::error("vertex shader input at location {0} does not match the "
+                    "vertex format",
+                    input.location);
+    }
   }
 }
 
 VulkanPipelineResource::~VulkanPipelineResource() {
   spdlog::debug("destroying graphics pipeline");
-  vkDestroyDescriptorSetLayout(device->getDevice(), descriptorLayout, nullptr);
-  vkDestroyPipeline(device->getDevice(), graphicsPipeline, nullptr);
-  vkDestroyPipelineLayout(device->getDevice(), pipelineLayout, nullptr);
-  for (int i = 0; i < createdModules.size(); i++) {
-    vkDestroyShaderModule(device->getDevice(), createdModules[i], nullptr);
-  }
+  // Background builds reference this resource
+  JobSystem::getInstance()->wait(&pendingBuilds);
+
+  VkDevice logicalDevice = device->getDevice();
+  std::vector<VkShaderModule> createdModules = this->createdModules;
+  std::vector<VkPipeline> pipelines;
+  variants.forEach([&pipelines](uint64_t key, VkPipeline &pipeline) {
+    pipelines.push_back(pipeline);
+  });
+
+  // Layouts belong to the device's layout cache and outlive the pipeline
+  device->getDeletionQueue()->defer([logicalDevice, pipelines, createdModules]() {
+    for (int i = 0; i < pipelines.size(); i++) {
+      vkDestroyPipeline(logicalDevice, pipelines[i], nullptr);
+    }
+    for (int i = 0; i < createdModules.size(); i++) {
+      vkDestroyShaderModule(logicalDevice, createdModules[i], nullptr);
+    }
+  });
 }
 
 void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
                                   const std::vector<char> &fragmentCode) {
-  createDescriptorSetLayout();
+  if (!createLayouts(vertexCode, fragmentCode)) {
+    return;
+  }
   VkShaderModule vertModule = createShaderModule(vertexCode);
   VkShaderModule fragModule = createShaderModule(fragmentCode);
 
   createdModules.push_back(vertModule);
   createdModules.push_back(fragModule);
 
+  setMemorySize(vertexCode.size() + fragmentCode.size(), 0);
+
+  auto bindingDescription = Vertex::getBindingDescription();
+  auto attributeDescriptions = Vertex::getAttributeDescriptions();
+  vertexLayoutHash = hashBytes(&bindingDescription, sizeof(bindingDescription)) ^
+                     hashBytes(attributeDescriptions.data(),
+                               sizeof(attributeDescriptions));
+
+  graphicsPipeline = getPipeline(PipelineState(), renderPassKey);
+  prewarmVariants();
+}
+
+uint64_t VulkanPipelineResource::getVariantKey(const PipelineState &state,
+                                               const RenderPassKey &renderPassKey) {
+  uint64_t hashes[] = {state.getHash(), renderPassKey.getHash(), vertexLayoutHash};
+  return hashBytes(hashes, sizeof(hashes));
+}
+
+VkPipeline VulkanPipelineResource::getPipeline(const PipelineState &state,
+                                               const RenderPassKey &renderPassKey) {
+  uint64_t key = getVariantKey(state, renderPassKey);
+
+  {
+    std::lock_guard<std::mutex> lock(variantMutex);
+    VkPipeline *cached = variants.find(key);
+    if (cached != nullptr) {
+      return *cached;
+    }
+  }
+
+  // Built without the lock so other variants can be created in parallel
+  VkPipeline pipeline = createVariant(state, renderPassKey);
+  if (pipeline == VK_NULL_HANDLE) {
+    // Lets requestPipeline queue the build again instead of skipping draws
+    // with this state for good
+    std::lock_guard<std::mutex> lock(variantMutex);
+    pendingVariants.erase(key);
+    return VK_NULL_HANDLE;
+  }
+
+  std::lock_guard<std::mutex> lock(variantMutex);
+  VkPipeline *cached = variants.find(key);
+  if (cached != nullptr) {
+    // Another thread built the same variant first
+    vkDestroyPipeline(device->getDevice(), pipeline, nullptr);
+    return *cached;
+  }
+  variants.insert(key) = pipeline;
+  pendingVariants.erase(key);
+
+  PipelineVariant variant;
+  variant.path = sourcePath;
+  variant.state = state;
+  variant.renderPassKey = renderPassKey;
+  device->getVariantLog()->record(variant);
+  return pipeline;
+}
+
+VkPipeline VulkanPipelineResource::requestPipeline(const PipelineState &state,
+                                                   const RenderPassKey &renderPassKey) {
+  uint64_t key = getVariantKey(state, renderPassKey);
+
+  std::lock_guard<std::mutex> lock(variantMutex);
+  VkPipeline *cached = variants.find(key);
+  if (cached != nullptr) {
+    return *cached;
+  }
+
+  if (pendingVariants.find(key) == nullptr) {
+    pendingVariants.insert(key) = true;
+    spdlog::debug("building pipeline variant of {0} in the background", sourcePath);
+    JobSystem::getInstance()->run([this, state, renderPassKey]() {
+      getPipeline(state, renderPassKey);
+    }, &pendingBuilds);
+  }
+  return VK_NULL_HANDLE;
+}
+
+void VulkanPipelineResource::prewarmVariants() {
+  std::vector<PipelineVariant> recorded =
+      device->getVariantLog()->getVariants(sourcePath, renderPassKey);
+
+  JobSystem::getInstance()->parallelFor(static_cast<uint32_t>(recorded.size()), 1, [this, &recorded](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      getPipeline(recorded[i].state, recorded[i].renderPassKey);
+    }
+  });
+
+  if (!recorded.empty()) {
+    spdlog::debug("prewarmed {0} pipeline variants of {1}", recorded.size(), sourcePath);
+  }
+}
+
+VkPipeline VulkanPipelineResource::createVariant(const PipelineState &state,
+                                                 const RenderPassKey &renderPassKey) {
+  // Nothing to build from when loading failed
+  if (pipelineLayout == VK_NULL_HANDLE || createdModules.size() < 2) {
+    return VK_NULL_HANDLE;
+  }
+
   VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
   vertShaderStageInfo.sType =
       VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-  vertShaderStageInfo.module = vertModule;
+  vertShaderStageInfo.module = createdModules[0];
   vertShaderStageInfo.pName = "main";
 
   VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
   fragShaderStageInfo.sType =
       VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-  fragShaderStageInfo.module = fragModule;
+  fragShaderStageInfo.module = createdModules[1];
   fragShaderStageInfo.pName = "main";
 
   std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
@@ -91,7 +241,7 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType =
       VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  inputAssembly.topology = state.topology;
   inputAssembly.primitiveRestartEnable = VK_FALSE;
 
   VkPipelineViewportStateCreateInfo viewportState = {};
@@ -103,10 +253,10 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
   rasterizer.depthClampEnable = VK_FALSE;
   rasterizer.rasterizerDiscardEnable = VK_FALSE;
-  rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterizer.polygonMode = state.polygonMode;
   rasterizer.lineWidth = 1.0f;
-  rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-  rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  rasterizer.cullMode = state.cullMode;
+  rasterizer.frontFace = state.frontFace;
   rasterizer.depthBiasEnable = VK_FALSE;
   rasterizer.depthBiasConstantFactor = 0.0f;
   rasterizer.depthBiasClamp = VK_FALSE;
@@ -116,13 +266,19 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   multisampling.sType =
       VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
   multisampling.sampleShadingEnable = VK_FALSE;
-  multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+  multisampling.rasterizationSamples = renderPassKey.samples;
 
   VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
   colorBlendAttachment.colorWriteMask =
       VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
       VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-  colorBlendAttachment.blendEnable = VK_FALSE;
+  colorBlendAttachment.blendEnable = state.blendEnable;
+  colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+  colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+  colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+  colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+  colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+  colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
   VkPipelineColorBlendStateCreateInfo colorBlending = {};
   colorBlending.sType =
@@ -131,6 +287,14 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   colorBlending.attachmentCount = 1;
   colorBlending.pAttachments = &colorBlendAttachment;
 
+  VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+  depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+  depthStencil.depthTestEnable = state.depthTestEnable;
+  depthStencil.depthWriteEnable = state.depthWriteEnable;
+  depthStencil.depthCompareOp = state.depthCompareOp;
+  depthStencil.depthBoundsTestEnable = VK_FALSE;
+  depthStencil.stencilTestEnable = VK_FALSE;
+
   VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT,
                                     VK_DYNAMIC_STATE_SCISSOR};
 
@@ -139,18 +303,6 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   dynamicState.dynamicStateCount = 2;
   dynamicState.pDynamicStates = dynamicStates;
 
-  VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-  pipelineLayoutInfo.setLayoutCount = 1;
-  pipelineLayoutInfo.pSetLayouts = &descriptorLayout;
-  
-  if (vkCreatePipelineLayout(device->getDevice(), &pipelineLayoutInfo, nullptr,
-                             &pipelineLayout) != VK_SUCCESS) {
-    spdlog::error("failed to create pipeline layout");
-  } else {
-    spdlog::debug("created pipeline layout");
-  }
-
   VkGraphicsPipelineCreateInfo pipelineInfo = {};
   pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
   pipelineInfo.stageCount = shaderStages.size();
@@ -160,24 +312,33 @@ void VulkanPipelineResource::load(const std::vector<char> &vertexCode,
   pipelineInfo.pViewportState = &viewportState;
   pipelineInfo.pRasterizationState = &rasterizer;
   pipelineInfo.pMultisampleState = &multisampling;
-  pipelineInfo.pDepthStencilState = nullptr;
+  pipelineInfo.pDepthStencilState = &depthStencil;
   pipelineInfo.pColorBlendState = &colorBlending;
   pipelineInfo.pDynamicState = &dynamicState;
   pipelineInfo.layout = pipelineLayout;
-  pipelineInfo.renderPass = renderPass;
+  // Any render pass compatible with the key can use the pipeline
+  pipelineInfo.renderPass =
+      device->getRenderPassCache()->getRenderPass(renderPassKey);
   pipelineInfo.subpass = 0;
 
-  if (vkCreateGraphicsPipelines(device->getDevice(), VK_NULL_HANDLE, 1,
+  VkPipeline pipeline;
+  if (vkCreateGraphicsPipelines(device->getDevice(), device->getPipelineCache(), 1,
                                 &pipelineInfo, nullptr,
-                                &graphicsPipeline) != VK_SUCCESS) {
+                                &pipeline) != VK_SUCCESS) {
     spdlog::error("error creating graphics pipeline");
-  } else {
-    spdlog::debug("created graphics pipeline");
+    return VK_NULL_HANDLE;
   }
+
+  spdlog::debug("created graphics pipeline");
+  return pipeline;
 }
 
 VkPipeline VulkanPipelineResource::getPipeline() { return graphicsPipeline; }
 
 VkPipelineLayout VulkanPipelineResource::getPipelineLayout() { return pipelineLayout; }
 
-VkDescriptorSetLayout VulkanPipelineResource::getDescriptorSetLayout() { return descriptorLayout; }
\ No newline at end of file
+VkDescriptorSetLayout VulkanPipelineResource::getDescriptorSetLayout(uint32_t set) {
+  return set < descriptorLayouts.size() ? descriptorLayouts[set] : VK_NULL_HANDLE;
+}
+
+VkPushConstantRange VulkanPipelineResource::getPushConstantRange() { return pushConstantRange; }
\ No newline at end of file
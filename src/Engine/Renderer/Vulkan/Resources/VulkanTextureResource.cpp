@@ -0,0 +1,208 @@
+#include "Engine/Renderer/Vulkan/Resources/VulkanTextureResource.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Engine/Renderer/Vulkan/VulkanTextureStreamer.h"
+
+// Satisfies the offset alignment of both block compressed and 4 byte texel
+// copies
+static const size_t MIP_COPY_ALIGNMENT = 16;
+
+static const uint32_t NO_MIP_REQUESTED = UINT32_MAX;
+
+VulkanTextureResource::VulkanTextureResource(VulkanDevice *device,
+                                             VulkanTextureStreamer *streamer,
+                                             const std::string &sourcePath,
+                                             const TextureData &texture,
+                                             const std::vector<char> &data,
+                                             VkSamplerAddressMode addressMode)
+    : requestedMip(NO_MIP_REQUESTED) {
+  this->device = device;
+  this->sourcePath = sourcePath;
+  this->layout = texture;
+
+  // Only a stored chain can be streamed, generated mips need the base level
+  if (streamer != nullptr && texture.mips.size() > 1) {
+    this->streamer = streamer;
+  }
+
+  loadImage(texture, data);
+  imageView = image->getView();
+  createSampler(addressMode);
+  setMemorySize(0, static_cast<size_t>(image->getAllocationSize()));
+
+  if (this->streamer != nullptr) {
+    this->streamer->registerTexture(this);
+  }
+}
+
+VulkanTextureResource::~VulkanTextureResource() {
+  if (streamer != nullptr) {
+    streamer->unregisterTexture(this);
+  }
+
+  // The view goes with the image, the sampler is shared
+  delete image;
+}
+
+void VulkanTextureResource::loadImage(const TextureData &texture,
+                                      const std::vector<char> &data) {
+  uint32_t storedLevels = static_cast<uint32_t>(texture.mips.size());
+  mipCount = storedLevels;
+
+  // Block compressed formats cannot be blitted, their chain must be stored
+  bool generateMips = !texture.isCompressed() &&
+                      storedLevels < getFullMipCount(texture.width, texture.height) &&
+                      VulkanImage::canGenerateMips(device, texture.format);
+  if (generateMips) {
+    mipCount = getFullMipCount(texture.width, texture.height);
+    // Generated levels have no source data to stream back in from
+    streamer = nullptr;
+  }
+
+  residentMip = streamer != nullptr ? getStreamingBaseMip() : 0;
+
+  std::vector<VkBufferImageCopy> regions;
+  size_t stagingSize = 0;
+  for (uint32_t level = residentMip; level < storedLevels; level++) {
+    const TextureMip &mip = texture.mips[level];
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = stagingSize;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level - residentMip;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {mip.width, mip.height, 1};
+    regions.push_back(region);
+
+    stagingSize += (mip.size + MIP_COPY_ALIGNMENT - 1) & ~(MIP_COPY_ALIGNMENT - 1);
+  }
+
+  VulkanBuffer stagingBuffer(device, stagingSize,
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VMA_MEMORY_USAGE_CPU_ONLY,
+                             VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                             MEMORY_POOL_STAGING);
+  for (uint32_t i = 0; i < regions.size(); i++) {
+    const TextureMip &mip = texture.mips[residentMip + i];
+    stagingBuffer.update(data.data() + mip.offset, mip.size,
+                         static_cast<size_t>(regions[i].bufferOffset));
+  }
+
+  VkImageUsageFlags usage =
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  // Blit sources when generating, copy sources when streaming
+  if (generateMips || streamer != nullptr) {
+    usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  }
+
+  const TextureMip &base = texture.mips[residentMip];
+  image = new VulkanImage(device, base.width, base.height, texture.format,
+                          mipCount - residentMip, usage,
+                          VMA_MEMORY_USAGE_GPU_ONLY, 0, MEMORY_POOL_TEXTURE);
+  stagingBuffer.retireAt(image->upload(
+      &stagingBuffer, regions, static_cast<uint32_t>(regions.size()),
+      generateMips));
+
+  spdlog::debug("uploaded {0}x{1} texture with mips {2} to {3} resident",
+                texture.width, texture.height, residentMip, mipCount - 1);
+}
+
+void VulkanTextureResource::createSampler(VkSamplerAddressMode addressMode) {
+  VkSamplerCreateInfo samplerInfo = {};
+  samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerInfo.magFilter = VK_FILTER_LINEAR;
+  samplerInfo.minFilter = VK_FILTER_LINEAR;
+  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+  samplerInfo.addressModeU = addressMode;
+  samplerInfo.addressModeV = addressMode;
+  samplerInfo.addressModeW = addressMode;
+  samplerInfo.mipLodBias = 0.0f;
+  samplerInfo.compareEnable = VK_FALSE;
+  samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+  samplerInfo.minLod = 0.0f;
+  // Unclamped so textures with any number of levels share the sampler,
+  // streamed images simply have fewer of them
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+  samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+  samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+  if (device->getEnabledFeatures().samplerAnisotropy) {
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy =
+        std::min(8.0f, device->getProperties().limits.maxSamplerAnisotropy);
+  }
+
+  sampler = device->getSamplerCache()->getSampler(samplerInfo);
+}
+
+VkImage VulkanTextureResource::getImage() { return image->getImage(); }
+
+VkImageView VulkanTextureResource::getImageView() { return imageView; }
+
+VkSampler VulkanTextureResource::getSampler() { return sampler; }
+
+uint32_t VulkanTextureResource::getMipLevels() { return mipCount; }
+
+bool VulkanTextureResource::isStreamed() { return streamer != nullptr; }
+
+uint32_t VulkanTextureResource::getMipForScreenSize(float pixels) {
+  float size = static_cast<float>(std::max(layout.width, layout.height));
+  if (pixels <= 1.0f) {
+    return mipCount - 1;
+  }
+
+  float mip = std::floor(std::log2(std::max(1.0f, size / pixels)));
+  return std::min(static_cast<uint32_t>(mip), mipCount - 1);
+}
+
+void VulkanTextureResource::requestMip(uint32_t mip) {
+  uint32_t current = requestedMip.load();
+  while (mip < current && !requestedMip.compare_exchange_weak(current, mip)) {
+  }
+}
+
+uint32_t VulkanTextureResource::takeRequestedMip() {
+  return requestedMip.exchange(NO_MIP_REQUESTED);
+}
+
+const std::string &VulkanTextureResource::getSourcePath() { return sourcePath; }
+
+const TextureData &VulkanTextureResource::getLayout() { return layout; }
+
+uint32_t VulkanTextureResource::getResidentMip() { return residentMip; }
+
+uint32_t VulkanTextureResource::getStreamingBaseMip() {
+  uint32_t mip = 0;
+  while (mip + 1 < mipCount &&
+         std::max(layout.mips[mip].width, layout.mips[mip].height) >
+             TEXTURE_STREAMING_BASE_SIZE) {
+    mip++;
+  }
+  return mip;
+}
+
+VkDeviceSize VulkanTextureResource::getResidentSize(uint32_t firstMip) {
+  VkDeviceSize size = 0;
+  for (uint32_t level = firstMip; level < mipCount; level++) {
+    size += getMipSize(layout.format, layout.mips[level].width,
+                       layout.mips[level].height);
+  }
+  return size;
+}
+
+VulkanImage *VulkanTextureResource::getVulkanImage() { return image; }
+
+void VulkanTextureResource::swapImage(VulkanImage *image,
+                                      uint32_t residentMip) {
+  delete this->image;
+
+  this->image = image;
+  this->residentMip = residentMip;
+  imageView = image->getView();
+  setMemorySize(0, static_cast<size_t>(image->getAllocationSize()));
+}
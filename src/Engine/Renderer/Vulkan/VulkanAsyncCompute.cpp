@@ -0,0 +1,100 @@
+#include "Engine/Renderer/Vulkan/VulkanAsyncCompute.h"
+
+VulkanAsyncCompute::VulkanAsyncCompute(VulkanDevice *device, int slotCount) {
+  this->device = device;
+  this->timeline = new VulkanTimeline(
+      device->getDevice(), device->getTimeline()->isTimelineSupported());
+
+  if (!isEnabled()) {
+    spdlog::debug("no async compute queue, compute is recorded inline");
+    return;
+  }
+
+  slots.resize(slotCount);
+
+  std::vector<VkCommandBuffer> commandBuffers(slotCount);
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = device->getComputeCommandPool();
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = static_cast<uint32_t>(slotCount);
+
+  if (vkAllocateCommandBuffers(device->getDevice(), &allocInfo,
+                               commandBuffers.data()) != VK_SUCCESS) {
+    spdlog::error("failed to allocate async compute command buffers");
+  }
+
+  VkSemaphoreCreateInfo semaphoreInfo = {};
+  semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+  for (int i = 0; i < slotCount; i++) {
+    slots[i].commandBuffer = commandBuffers[i];
+    if (vkCreateSemaphore(device->getDevice(), &semaphoreInfo, nullptr,
+                          &slots[i].finished) != VK_SUCCESS) {
+      spdlog::error("failed to create async compute semaphore");
+    }
+  }
+
+  spdlog::debug("created async compute command buffers");
+}
+
+VulkanAsyncCompute::~VulkanAsyncCompute() {
+  for (int i = 0; i < slots.size(); i++) {
+    timeline->wait(slots[i].submitValue);
+    vkFreeCommandBuffers(device->getDevice(), device->getComputeCommandPool(),
+                         1, &slots[i].commandBuffer);
+    vkDestroySemaphore(device->getDevice(), slots[i].finished, nullptr);
+  }
+  slots.clear();
+
+  delete timeline;
+}
+
+bool VulkanAsyncCompute::isEnabled() { return device->hasAsyncCompute(); }
+
+uint32_t VulkanAsyncCompute::getQueueFamily() {
+  return device->queueFamilyIndices.compute;
+}
+
+VkCommandBuffer VulkanAsyncCompute::begin(const VulkanRenderFrame &frame) {
+  Slot &slot = slots[frame.currentFrameIndex];
+  if (slot.recording) {
+    return slot.commandBuffer;
+  }
+
+  // Usually long done, the graphics work that waited on it already finished
+  timeline->wait(slot.submitValue);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  if (vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS) {
+    spdlog::error("failed to begin async compute command buffer");
+  }
+  slot.recording = true;
+  return slot.commandBuffer;
+}
+
+void VulkanAsyncCompute::submit(VulkanRenderFrame &frame,
+                                VkPipelineStageFlags waitStages) {
+  Slot &slot = slots[frame.currentFrameIndex];
+  if (!slot.recording) {
+    return;
+  }
+
+  if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+    spdlog::error("failed to record async compute command buffer");
+  }
+  slot.recording = false;
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &slot.commandBuffer;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &slot.finished;
+
+  slot.submitValue = timeline->submit(device->getComputeQueue(), submitInfo);
+  frame.waitFor(slot.finished, waitStages);
+}
@@ -1,11 +1,13 @@
 #include "Engine/Renderer/Vulkan/VulkanBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanDefragmenter.h"
 
 VulkanBuffer::VulkanBuffer(VulkanDevice *device, VkDeviceSize size,
                            VkBufferUsageFlags buffer_usage,
                            VmaMemoryUsage memory_usage,
-                           VmaAllocationCreateFlags flags) {
+                           VmaAllocationCreateFlags flags, MEMORY_POOL pool) {
   this->device = device;
   this->size = size;
+  this->usage = buffer_usage;
   VkBufferCreateInfo bufferInfo = {};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.usage = buffer_usage;
@@ -14,6 +16,7 @@ VulkanBuffer::VulkanBuffer(VulkanDevice *device, VkDeviceSize size,
   VmaAllocationCreateInfo memoryInfo{};
   memoryInfo.flags = flags;
   memoryInfo.usage = memory_usage;
+  memoryInfo.pool = device->getMemoryPools()->getPool(pool);
 
   VmaAllocationInfo allocationInfo{};
 
@@ -21,18 +24,44 @@ VulkanBuffer::VulkanBuffer(VulkanDevice *device, VkDeviceSize size,
       vmaCreateBuffer(device->getAllocator(), &bufferInfo, &memoryInfo, &buffer,
                       &allocation, &allocationInfo);
 
+  // A full pool or an incompatible memory type, the default pools still work
+  if (result != VK_SUCCESS && memoryInfo.pool != VK_NULL_HANDLE) {
+    spdlog::debug("{0} memory pool cannot hold buffer of {1} bytes",
+                  VulkanMemoryPools::getPoolName(pool), size);
+    memoryInfo.pool = VK_NULL_HANDLE;
+    result = vmaCreateBuffer(device->getAllocator(), &bufferInfo, &memoryInfo,
+                             &buffer, &allocation, &allocationInfo);
+  }
+
   if (result != VK_SUCCESS) {
-    spdlog::error("failed to create vulkan buffer");
-  } else {
-    spdlog::debug("created vulkan buffer");
+    spdlog::error("failed to create vulkan buffer of {0} bytes", size);
+    return;
   }
 
   memory = allocationInfo.deviceMemory;
+  allocationSize = allocationInfo.size;
+  device->getMemoryStats()->recordAllocation(allocationSize);
+  spdlog::debug("created vulkan buffer of {0} bytes", allocationSize);
 }
 
 VulkanBuffer::~VulkanBuffer() {
   if (buffer != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE) {
-    vmaDestroyBuffer(device->getAllocator(), buffer, allocation);
+    device->getMemoryStats()->recordFree(allocationSize);
+
+    VmaAllocator allocator = device->getAllocator();
+    VkBuffer buffer = this->buffer;
+    VmaAllocation allocation = this->allocation;
+
+    std::function<void()> deleter = [allocator, buffer, allocation]() {
+      vmaDestroyBuffer(allocator, buffer, allocation);
+    };
+    if (relocatable) {
+      device->getDefragmenter()->unregisterBuffer(this, std::move(deleter));
+    } else if (retireValue != 0) {
+      device->getDeletionQueue()->defer(retireValue, std::move(deleter));
+    } else {
+      device->getDeletionQueue()->defer(std::move(deleter));
+    }
   }
 }
 
@@ -74,21 +103,8 @@ void VulkanBuffer::update(const void *data, size_t size, size_t offset) {
   unmap();
 }
 
-void VulkanBuffer::transferDataFrom(VulkanBuffer *otherBuffer) {
-  VkCommandBufferAllocateInfo allocInfo = {};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = device->getCommandPool();
-  allocInfo.commandBufferCount = 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device->getDevice(), &allocInfo, &commandBuffer);
-
-  VkCommandBufferBeginInfo beginInfo = {};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+uint64_t VulkanBuffer::transferDataFrom(VulkanBuffer *otherBuffer) {
+  VkCommandBuffer commandBuffer = device->beginTransferCommands();
 
   VkBufferCopy copyRegion = {};
   copyRegion.size = otherBuffer->getSize();
@@ -96,20 +112,83 @@ void VulkanBuffer::transferDataFrom(VulkanBuffer *otherBuffer) {
   vkCmdCopyBuffer(commandBuffer, otherBuffer->getBuffer(), getBuffer(), 1,
                   &copyRegion);
 
-  vkEndCommandBuffer(commandBuffer);
+  // Frames drawing with the buffer are submitted later on the same queue
+  VkBufferMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                          VK_ACCESS_INDEX_READ_BIT |
+                          VK_ACCESS_SHADER_READ_BIT;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer = getBuffer();
+  barrier.offset = 0;
+  barrier.size = VK_WHOLE_SIZE;
+
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                           VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+  return device->submitTransferCommands(commandBuffer);
+}
+
+void VulkanBuffer::retireAt(uint64_t value) { retireValue = value; }
+
+void VulkanBuffer::setRelocatable() {
+  VkBufferUsageFlags movableUsage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  if ((usage & ~movableUsage) != 0) {
+    spdlog::error("buffer with usage {0:#x} may be bound in descriptor sets "
+                  "and cannot be relocated",
+                  usage);
+    return;
+  }
+
+  if (!relocatable && allocation != VK_NULL_HANDLE) {
+    relocatable = true;
+    device->getDefragmenter()->registerBuffer(this);
+  }
+}
+
+void VulkanBuffer::rebind() {
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.usage = usage;
+  bufferInfo.size = size;
 
-  VkSubmitInfo submitInfo = {};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
+  VkBuffer moved;
+  if (vkCreateBuffer(device->getDevice(), &bufferInfo, nullptr, &moved) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to recreate moved vulkan buffer");
+    return;
+  }
+  if (vmaBindBufferMemory(device->getAllocator(), allocation, moved) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to bind moved vulkan buffer");
+    vkDestroyBuffer(device->getDevice(), moved, nullptr);
+    return;
+  }
 
-  vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(device->getGraphicsQueue());
+  VkDevice logicalDevice = device->getDevice();
+  VkBuffer old = buffer;
+  device->getDeletionQueue()->defer([logicalDevice, old]() {
+    vkDestroyBuffer(logicalDevice, old, nullptr);
+  });
+  buffer = moved;
 
-  vkFreeCommandBuffers(device->getDevice(), device->getCommandPool(), 1,
-                       &commandBuffer);
+  VmaAllocationInfo allocationInfo{};
+  vmaGetAllocationInfo(device->getAllocator(), allocation, &allocationInfo);
+  memory = allocationInfo.deviceMemory;
 }
 
 VkBuffer VulkanBuffer::getBuffer() { return buffer; }
 
-VkDeviceSize VulkanBuffer::getSize() { return size; }
\ No newline at end of file
+VmaAllocation VulkanBuffer::getAllocation() { return allocation; }
+
+VkDeviceSize VulkanBuffer::getSize() { return size; }
+
+VkDeviceSize VulkanBuffer::getAllocationSize() { return allocationSize; }
\ No newline at end of file
@@ -0,0 +1,527 @@
+#include "Engine/Renderer/Vulkan/VulkanCullingPass.h"
+
+#include <algorithm>
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanMeshInstanceResource.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanResourceIds.h"
+
+// Storage buffers of the cull set, in binding order
+const uint32_t CULL_BINDING_COUNT = 5;
+// Buffers handed from the compute queue to the graphics queue
+const uint32_t CULL_TRANSFER_BUFFER_COUNT = 3;
+
+static void extractFrustumPlanes(const glm::mat4 &viewProjection,
+                                 glm::vec4 planes[6]) {
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; i++) {
+    rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                        viewProjection[2][i], viewProjection[3][i]);
+  }
+
+  // Left, right, bottom, top, near and far, for glm's -1 to 1 clip depth
+  planes[0] = rows[3] + rows[0];
+  planes[1] = rows[3] - rows[0];
+  planes[2] = rows[3] + rows[1];
+  planes[3] = rows[3] - rows[1];
+  planes[4] = rows[3] + rows[2];
+  planes[5] = rows[3] - rows[2];
+
+  // Normalised so the shader compares distances against sphere radii
+  for (int i = 0; i < 6; i++) {
+    planes[i] /= glm::length(glm::vec3(planes[i]));
+  }
+}
+
+// Bijective mix of the handle, so distinct handles never share a key and the
+// map gets the well spread keys it expects
+static uint64_t hashHandle(ResourceHandle<VulkanMeshInstanceResource> handle) {
+  uint64_t key = (static_cast<uint64_t>(handle.generation) << 32) | handle.index;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+  return key ^ (key >> 31);
+}
+
+static void recordMemoryBarrier(VkCommandBuffer commandBuffer,
+                                VkAccessFlags srcAccess,
+                                VkAccessFlags dstAccess,
+                                VkPipelineStageFlags srcStage,
+                                VkPipelineStageFlags dstStage) {
+  VkMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = srcAccess;
+  barrier.dstAccessMask = dstAccess;
+  vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+}
+
+// Hands buffers written on the compute queue over to the graphics queue, or
+// takes them over on the graphics side when recorded with the acquire masks
+static void recordOwnershipTransfer(VkCommandBuffer commandBuffer,
+                                    const VkBuffer *buffers,
+                                    uint32_t bufferCount, uint32_t srcFamily, uint32_t dstFamily,
+                                    VkAccessFlags srcAccess,
+                                    VkAccessFlags dstAccess,
+                                    VkPipelineStageFlags srcStage,
+                                    VkPipelineStageFlags dstStage) {
+  VkBufferMemoryBarrier barriers[CULL_TRANSFER_BUFFER_COUNT] = {};
+  for (uint32_t i = 0; i < bufferCount; i++) {
+    barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barriers[i].srcAccessMask = srcAccess;
+    barriers[i].dstAccessMask = dstAccess;
+    barriers[i].srcQueueFamilyIndex = srcFamily;
+    barriers[i].dstQueueFamilyIndex = dstFamily;
+    barriers[i].buffer = buffers[i];
+    barriers[i].offset = 0;
+    barriers[i].size = VK_WHOLE_SIZE;
+  }
+  vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr,
+                       bufferCount, barriers, 0, nullptr);
+}
+
+VulkanCullingPass::VulkanCullingPass(
+    VulkanDevice *device, VulkanAsyncCompute *asyncCompute,
+    uint32_t maxInstances, int frameCount, VkDescriptorSetLayout drawSetLayout,
+    const std::vector<VulkanBuffer *> &cameraBuffers) {
+  this->pipelineHandle =
+      ResourceManager::getInstance()->acquire(CULL_PIPELINE_RESOURCE);
+  this->device = device;
+  this->asyncCompute = asyncCompute;
+  this->maxInstances = maxInstances;
+  this->maxBatches = maxInstances;
+  this->frameCount = frameCount;
+  this->changeHistory.resize(frameCount);
+  createBuffers();
+  createDescriptors(drawSetLayout, cameraBuffers);
+}
+
+VulkanCullingPass::~VulkanCullingPass() {
+  for (int i = 0; i < frames.size(); i++) {
+    delete frames[i].instances;
+    delete frames[i].batches;
+    delete frames[i].commands;
+    delete frames[i].counts;
+    delete frames[i].visibleModels;
+  }
+  frames.clear();
+
+  VkDevice logicalDevice = device->getDevice();
+  VkDescriptorPool descriptorPool = this->descriptorPool;
+  device->getDeletionQueue()->defer([logicalDevice, descriptorPool]() {
+    vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
+  });
+
+  ResourceManager::getInstance()->release(pipelineHandle);
+}
+
+bool VulkanCullingPass::isSupported(VulkanDevice *device) {
+  VkPhysicalDeviceFeatures features = device->getEnabledFeatures();
+  return device->isDrawIndirectCountEnabled() && features.multiDrawIndirect &&
+         features.drawIndirectFirstInstance;
+}
+
+void VulkanCullingPass::createBuffers() {
+  frames.resize(frameCount);
+
+  for (int i = 0; i < frameCount; i++) {
+    // Written by the CPU, instances only where they changed
+    frames[i].instances = new VulkanBuffer(
+        device, sizeof(CullInstance) * maxInstances,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+        VMA_ALLOCATION_CREATE_MAPPED_BIT, MEMORY_POOL_FRAME);
+    frames[i].batches = new VulkanBuffer(
+        device, sizeof(CullBatch) * maxBatches,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+        VMA_ALLOCATION_CREATE_MAPPED_BIT, MEMORY_POOL_FRAME);
+
+    // Written and read by the GPU only
+    frames[i].commands = new VulkanBuffer(
+        device, sizeof(VkDrawIndexedIndirectCommand) * maxInstances,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, 0);
+    frames[i].counts = new VulkanBuffer(
+        device, sizeof(uint32_t) * maxBatches,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, 0);
+    frames[i].visibleModels = new VulkanBuffer(
+        device, sizeof(glm::mat4) * maxInstances,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, 0);
+  }
+}
+
+void VulkanCullingPass::createDescriptors(
+    VkDescriptorSetLayout drawSetLayout,
+    const std::vector<VulkanBuffer *> &cameraBuffers) {
+  VkDescriptorPoolSize poolSizes[2] = {};
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  poolSizes[0].descriptorCount =
+      static_cast<uint32_t>(frameCount * (CULL_BINDING_COUNT + 1));
+  poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount);
+
+  VkDescriptorPoolCreateInfo poolInfo = {};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.poolSizeCount = 2;
+  poolInfo.pPoolSizes = poolSizes;
+  poolInfo.maxSets = static_cast<uint32_t>(frameCount * 2);
+
+  if (vkCreateDescriptorPool(device->getDevice(), &poolInfo, nullptr,
+                             &descriptorPool) != VK_SUCCESS) {
+    spdlog::error("failed to create cull descriptor pool");
+    return;
+  }
+
+  // Shared by signature with every reload of the cull shader
+  VulkanComputePipelineResource *pipeline =
+      ResourceManager::resolve(pipelineHandle);
+  VkDescriptorSetLayout cullSetLayout = pipeline->getDescriptorSetLayout();
+
+  for (int i = 0; i < frameCount; i++) {
+    VkDescriptorSetLayout setLayouts[] = {cullSetLayout, drawSetLayout};
+    VkDescriptorSet sets[2];
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 2;
+    allocInfo.pSetLayouts = setLayouts;
+
+    if (vkAllocateDescriptorSets(device->getDevice(), &allocInfo, sets) !=
+        VK_SUCCESS) {
+      spdlog::error("failed to allocate cull descriptor sets");
+      return;
+    }
+    frames[i].cullSet = sets[0];
+    frames[i].drawSet = sets[1];
+
+    VulkanBuffer *cullBuffers[CULL_BINDING_COUNT] = {
+        frames[i].instances, frames[i].batches, frames[i].commands,
+        frames[i].counts, frames[i].visibleModels};
+
+    VkDescriptorBufferInfo bufferInfos[CULL_BINDING_COUNT + 2] = {};
+    VkWriteDescriptorSet writes[CULL_BINDING_COUNT + 2] = {};
+    for (uint32_t binding = 0; binding < CULL_BINDING_COUNT; binding++) {
+      bufferInfos[binding].buffer = cullBuffers[binding]->getBuffer();
+      bufferInfos[binding].range = VK_WHOLE_SIZE;
+
+      writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      writes[binding].dstSet = frames[i].cullSet;
+      writes[binding].dstBinding = binding;
+      writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      writes[binding].descriptorCount = 1;
+      writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+
+    VkDescriptorBufferInfo &cameraInfo = bufferInfos[CULL_BINDING_COUNT];
+    cameraInfo.buffer = cameraBuffers[i]->getBuffer();
+    cameraInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet &cameraWrite = writes[CULL_BINDING_COUNT];
+    cameraWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    cameraWrite.dstSet = frames[i].drawSet;
+    cameraWrite.dstBinding = 0;
+    cameraWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    cameraWrite.descriptorCount = 1;
+    cameraWrite.pBufferInfo = &cameraInfo;
+
+    VkDescriptorBufferInfo &modelsInfo = bufferInfos[CULL_BINDING_COUNT + 1];
+    modelsInfo.buffer = frames[i].visibleModels->getBuffer();
+    modelsInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet &modelsWrite = writes[CULL_BINDING_COUNT + 1];
+    modelsWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    modelsWrite.dstSet = frames[i].drawSet;
+    modelsWrite.dstBinding = 1;
+    modelsWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    modelsWrite.descriptorCount = 1;
+    modelsWrite.pBufferInfo = &modelsInfo;
+
+    vkUpdateDescriptorSets(device->getDevice(), CULL_BINDING_COUNT + 2, writes,
+                           0, nullptr);
+  }
+
+  spdlog::debug("created cull descriptor sets");
+}
+
+uint32_t VulkanCullingPass::acquireBatch(
+    ResourceHandle<VulkanMeshInstanceResource> handle) {
+  uint64_t key = hashHandle(handle);
+  uint32_t *found = handleBatches.find(key);
+  if (found != nullptr) {
+    batchSizes[*found]++;
+    return *found;
+  }
+
+  uint32_t batch;
+  if (!freeBatches.empty()) {
+    batch = freeBatches.back();
+    freeBatches.pop_back();
+  } else {
+    batch = static_cast<uint32_t>(batches.size());
+    batches.push_back({});
+    batchHandles.push_back({});
+    batchMeshes.push_back(nullptr);
+    batchSizes.push_back(0);
+  }
+
+  batchHandles[batch] = handle;
+  batchSizes[batch] = 1;
+  handleBatches.insert(key) = batch;
+  return batch;
+}
+
+void VulkanCullingPass::releaseBatch(uint32_t batch) {
+  batchSizes[batch]--;
+  if (batchSizes[batch] > 0) {
+    return;
+  }
+
+  handleBatches.erase(hashHandle(batchHandles[batch]));
+  batchHandles[batch] = {};
+  batchMeshes[batch] = nullptr;
+  freeBatches.push_back(batch);
+}
+
+void VulkanCullingPass::writeInstance(uint32_t index, const MeshDraw &draw,
+                                      bool assigned) {
+  CullInstance &instance = instances[index];
+  ResourceHandle<VulkanMeshInstanceResource> handle = draw.meshInstance;
+
+  // Released before acquiring so live batches never outnumber instances
+  if (!assigned) {
+    instance.batch = acquireBatch(handle);
+  } else if (batchHandles[instance.batch].index != handle.index ||
+             batchHandles[instance.batch].generation != handle.generation) {
+    releaseBatch(instance.batch);
+    instance.batch = acquireBatch(handle);
+  }
+  instance.model = draw.model;
+  changeHistory[cullFrame % frameCount].push_back(index);
+}
+
+void VulkanCullingPass::syncInstances(const RenderSnapshot &snapshot) {
+  cullFrame++;
+  changeHistory[cullFrame % frameCount].clear();
+
+  uint32_t drawCount = static_cast<uint32_t>(snapshot.meshDraws.size());
+  if (drawCount > maxInstances) {
+    if (!overflowWarned) {
+      spdlog::warn("more than {0} mesh instances, culling the first {0}",
+                   maxInstances);
+      overflowWarned = true;
+    }
+    drawCount = maxInstances;
+  }
+
+  // The changes of a snapshot that never got here are unknown
+  bool rebuild = !synced || snapshot.frameNumber != snapshotFrame + 1;
+  synced = true;
+  snapshotFrame = snapshot.frameNumber;
+
+  // Draws that went away give their batch up
+  while (instanceCount > drawCount) {
+    instanceCount--;
+    releaseBatch(instances[instanceCount].batch);
+  }
+  if (instances.size() < drawCount) {
+    instances.resize(drawCount);
+  }
+
+  if (rebuild) {
+    for (uint32_t i = 0; i < drawCount; i++) {
+      writeInstance(i, snapshot.meshDraws[i], i < instanceCount);
+    }
+  } else {
+    for (uint32_t i = 0; i < snapshot.changedDrawCount; i++) {
+      uint32_t index = snapshot.changedDraws[i];
+      if (index < instanceCount) {
+        writeInstance(index, snapshot.meshDraws[index], true);
+      }
+    }
+    for (uint32_t i = instanceCount; i < drawCount; i++) {
+      writeInstance(i, snapshot.meshDraws[i], false);
+    }
+  }
+  instanceCount = drawCount;
+}
+
+void VulkanCullingPass::updateBatches() {
+  // Reloads can swap the mesh behind a handle, so every live batch resolves
+  // its mesh again. Each gets room for all of its instances surviving the
+  // cull, batches without a loaded mesh get none and draw nothing.
+  uint32_t commandOffset = 0;
+  for (uint32_t i = 0; i < batches.size(); i++) {
+    if (batchSizes[i] == 0) {
+      continue;
+    }
+
+    VulkanMeshInstanceResource *meshInstance =
+        ResourceManager::resolve(batchHandles[i]);
+    VulkanMeshResource *mesh =
+        meshInstance != nullptr ? meshInstance->getMesh() : nullptr;
+    batchMeshes[i] = mesh;
+    batches[i].commandOffset = commandOffset;
+    if (mesh == nullptr) {
+      batches[i].indexCount = 0;
+      batches[i].bounds = glm::vec4(0.0f);
+      continue;
+    }
+
+    batches[i].indexCount = static_cast<uint32_t>(mesh->getIndexCount());
+    batches[i].bounds = mesh->getBounds();
+    commandOffset += batchSizes[i];
+  }
+}
+
+void VulkanCullingPass::uploadInstances(FrameResources &resources) {
+  // A buffer that missed more frames than the history holds is rewritten
+  if (resources.syncedFrame == 0 ||
+      cullFrame - resources.syncedFrame > static_cast<uint64_t>(frameCount)) {
+    resources.instances->update(instances.data(),
+                                sizeof(CullInstance) * instanceCount, 0);
+    resources.syncedFrame = cullFrame;
+    return;
+  }
+
+  uploadIndices.clear();
+  for (uint64_t f = resources.syncedFrame + 1; f <= cullFrame; f++) {
+    std::vector<uint32_t> &changes = changeHistory[f % frameCount];
+    uploadIndices.insert(uploadIndices.end(), changes.begin(), changes.end());
+  }
+  std::sort(uploadIndices.begin(), uploadIndices.end());
+  uploadIndices.erase(std::unique(uploadIndices.begin(), uploadIndices.end()),
+                      uploadIndices.end());
+
+  // Contiguous runs of changed instances are written with one copy each,
+  // instances removed since are skipped
+  uint32_t i = 0;
+  while (i < uploadIndices.size() && uploadIndices[i] < instanceCount) {
+    uint32_t first = uploadIndices[i];
+    uint32_t last = first;
+    i++;
+    while (i < uploadIndices.size() && uploadIndices[i] == last + 1 &&
+           uploadIndices[i] < instanceCount) {
+      last++;
+      i++;
+    }
+    resources.instances->update(&instances[first],
+                                sizeof(CullInstance) * (last - first + 1),
+                                sizeof(CullInstance) * first);
+  }
+  resources.syncedFrame = cullFrame;
+}
+
+void VulkanCullingPass::cull(VulkanRenderFrame &frame,
+                             const RenderSnapshot &snapshot) {
+  syncInstances(snapshot);
+  updateBatches();
+
+  culled = false;
+  VulkanComputePipelineResource *pipeline =
+      ResourceManager::resolve(pipelineHandle);
+  if (pipeline->getPipeline() == VK_NULL_HANDLE || instanceCount == 0) {
+    return;
+  }
+  culled = true;
+
+  uint32_t batchCount = static_cast<uint32_t>(batches.size());
+  FrameResources &resources = frames[frame.currentFrameIndex];
+  uploadInstances(resources);
+  // One entry per mesh instance resource, small enough to write whole
+  // every frame
+  resources.batches->update(batches.data(), sizeof(CullBatch) * batchCount, 0);
+
+  bool async = asyncCompute->isEnabled();
+  VkCommandBuffer commandBuffer =
+      async ? asyncCompute->begin(frame) : frame.commandBuffer;
+
+  // The previous use of this frame's buffers finished before its command
+  // buffer was reset, only the indirect reads of this frame need ordering
+  vkCmdFillBuffer(commandBuffer, resources.counts->getBuffer(), 0,
+                  sizeof(uint32_t) * batchCount, 0);
+  recordMemoryBarrier(commandBuffer, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  CullPushConstants pushConstants = {};
+  extractFrustumPlanes(snapshot.viewProjection, pushConstants.frustumPlanes);
+  pushConstants.instanceCount = instanceCount;
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    pipeline->getPipeline());
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          pipeline->getPipelineLayout(), 0, 1,
+                          &resources.cullSet, 0, nullptr);
+  vkCmdPushConstants(commandBuffer, pipeline->getPipelineLayout(),
+                     VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants),
+                     &pushConstants);
+  vkCmdDispatch(commandBuffer,
+                (pushConstants.instanceCount + CULL_GROUP_SIZE - 1) /
+                    CULL_GROUP_SIZE,
+                1, 1);
+
+  VkPipelineStageFlags drawStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+  if (!async) {
+    recordMemoryBarrier(commandBuffer, VK_ACCESS_SHADER_WRITE_BIT,
+                        VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, drawStages);
+    return;
+  }
+
+  // Previous contents are never read, so nothing is handed back to the
+  // compute queue before it overwrites them next time
+  VkBuffer drawBuffers[CULL_TRANSFER_BUFFER_COUNT] = {
+      resources.commands->getBuffer(), resources.counts->getBuffer(),
+      resources.visibleModels->getBuffer()};
+  uint32_t computeFamily = asyncCompute->getQueueFamily();
+  uint32_t graphicsFamily = device->queueFamilyIndices.graphics;
+
+  recordOwnershipTransfer(commandBuffer, drawBuffers,
+                          CULL_TRANSFER_BUFFER_COUNT, computeFamily,
+                          graphicsFamily, VK_ACCESS_SHADER_WRITE_BIT, 0,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  asyncCompute->submit(frame, drawStages);
+
+  recordOwnershipTransfer(frame.commandBuffer, drawBuffers,
+                          CULL_TRANSFER_BUFFER_COUNT, computeFamily,
+                          graphicsFamily, 0,
+                          VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                              VK_ACCESS_SHADER_READ_BIT,
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, drawStages);
+}
+
+void VulkanCullingPass::draw(const VulkanRenderFrame &frame,
+                             VkPipelineLayout drawLayout) {
+  if (!culled) {
+    return;
+  }
+
+  FrameResources &resources = frames[frame.currentFrameIndex];
+  VkCommandBuffer commandBuffer = frame.commandBuffer;
+
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          drawLayout, 0, 1, &resources.drawSet, 0, nullptr);
+
+  const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+  for (uint32_t i = 0; i < batches.size(); i++) {
+    if (batchSizes[i] == 0 || batchMeshes[i] == nullptr) {
+      continue;
+    }
+
+    VkBuffer vertexBuffers[] = {batchMeshes[i]->getVertexBuffer()};
+    VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, batchMeshes[i]->getIndexBuffer(), 0,
+                         VK_INDEX_TYPE_UINT16);
+
+    vkCmdDrawIndexedIndirectCountKHR(
+        commandBuffer, resources.commands->getBuffer(),
+        batches[i].commandOffset * stride, resources.counts->getBuffer(),
+        i * sizeof(uint32_t), batchSizes[i], stride);
+  }
+}
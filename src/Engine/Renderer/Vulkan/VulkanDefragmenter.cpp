@@ -0,0 +1,217 @@
+#include "Engine/Renderer/Vulkan/VulkanDefragmenter.h"
+
+#include <algorithm>
+
+#include "Engine/Renderer/Vulkan/VulkanBuffer.h"
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+
+static void recordMemoryBarrier(VkCommandBuffer commandBuffer,
+                                VkAccessFlags srcAccess,
+                                VkAccessFlags dstAccess,
+                                VkPipelineStageFlags srcStage,
+                                VkPipelineStageFlags dstStage) {
+  VkMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = srcAccess;
+  barrier.dstAccessMask = dstAccess;
+  vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+}
+
+VulkanDefragmenter::VulkanDefragmenter(VulkanDevice *device) {
+  this->device = device;
+}
+
+VulkanDefragmenter::~VulkanDefragmenter() {
+  std::lock_guard<std::mutex> lock(mutex);
+  finishPass(true);
+}
+
+FragmentationStats VulkanDefragmenter::getFragmentationStats() {
+  VmaStats stats;
+  vmaCalculateStats(device->getAllocator(), &stats);
+
+  FragmentationStats fragmentation;
+  fragmentation.usedBytes = stats.total.usedBytes;
+  fragmentation.unusedBytes = stats.total.unusedBytes;
+  fragmentation.largestUnusedRange =
+      stats.total.unusedRangeCount > 0 ? stats.total.unusedRangeSizeMax : 0;
+  fragmentation.blockCount = stats.total.blockCount;
+  return fragmentation;
+}
+
+void VulkanDefragmenter::registerBuffer(VulkanBuffer *buffer) {
+  std::lock_guard<std::mutex> lock(mutex);
+  buffers.push_back(buffer);
+}
+
+void VulkanDefragmenter::unregisterBuffer(VulkanBuffer *buffer,
+                                          std::function<void()> deleter) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  for (int i = 0; i < buffers.size(); i++) {
+    if (buffers[i] == buffer) {
+      buffers[i] = buffers.back();
+      buffers.pop_back();
+      // The freed range is only reclaimed once its neighbours move
+      fragmented = true;
+      break;
+    }
+  }
+
+  // VMA must not see an allocation of the pending pass freed before the
+  // pass ends
+  if (passPending &&
+      std::find(pendingAllocations.begin(), pendingAllocations.end(),
+                buffer->getAllocation()) != pendingAllocations.end()) {
+    pendingDeleters.push_back(std::move(deleter));
+    return;
+  }
+  device->getDeletionQueue()->defer(std::move(deleter));
+}
+
+bool VulkanDefragmenter::runPass() {
+  std::vector<VmaAllocation> allocations;
+  for (int i = 0; i < buffers.size(); i++) {
+    allocations.push_back(buffers[i]->getAllocation());
+  }
+  std::vector<VkBool32> changed(allocations.size(), VK_FALSE);
+
+  VkDevice logicalDevice = device->getDevice();
+  VkCommandPool commandPool = device->getCommandPool();
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+
+  VkCommandBuffer commandBuffer;
+  vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+  // Relocatable buffers are only read as vertex and index data, frames
+  // submitted earlier may still do so from ranges being overwritten
+  recordMemoryBarrier(commandBuffer, 0,
+                      VK_ACCESS_TRANSFER_READ_BIT |
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  // GPU copies only, CPU moves would race frames still reading the memory
+  VmaDefragmentationInfo2 info = {};
+  info.allocationCount = static_cast<uint32_t>(allocations.size());
+  info.pAllocations = allocations.data();
+  info.pAllocationsChanged = changed.data();
+  info.maxCpuBytesToMove = 0;
+  info.maxCpuAllocationsToMove = 0;
+  info.maxGpuBytesToMove = DEFRAGMENTATION_BYTES_PER_PASS;
+  info.maxGpuAllocationsToMove = DEFRAGMENTATION_MOVES_PER_PASS;
+  info.commandBuffer = commandBuffer;
+
+  VmaDefragmentationStats stats = {};
+  VmaDefragmentationContext context;
+  VkResult result = vmaDefragmentationBegin(device->getAllocator(), &info,
+                                            &stats, &context);
+
+  // Frames submitted later read the moved data through the new handles
+  recordMemoryBarrier(commandBuffer, VK_ACCESS_TRANSFER_WRITE_BIT,
+                      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                          VK_ACCESS_INDEX_READ_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+  vkEndCommandBuffer(commandBuffer);
+
+  if (result < VK_SUCCESS) {
+    spdlog::error("failed to begin gpu memory defragmentation");
+    vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+    return false;
+  }
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+
+  passPending = true;
+  pendingContext = context;
+  pendingAllocations.swap(allocations);
+  pendingValue =
+      device->getTimeline()->submit(device->getGraphicsQueue(), submitInfo);
+
+  // Retired with the next frame, which completes after the copies
+  device->getDeletionQueue()->defer([logicalDevice, commandPool, commandBuffer]() {
+    vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+  });
+
+  // The allocations already report their new place. Rebinding now instead
+  // of once the copies finish keeps later frames off the old ranges, which
+  // other moves of this pass may overwrite.
+  for (int i = 0; i < buffers.size(); i++) {
+    if (changed[i]) {
+      buffers[i]->rebind();
+    }
+  }
+
+  bytesMoved += stats.bytesMoved;
+  allocationsMoved += stats.allocationsMoved;
+  return stats.allocationsMoved > 0;
+}
+
+bool VulkanDefragmenter::finishPass(bool block) {
+  if (!passPending) {
+    return true;
+  }
+
+  VulkanTimeline *timeline = device->getTimeline();
+  if (block) {
+    timeline->wait(pendingValue);
+  } else if (!timeline->isComplete(pendingValue)) {
+    return false;
+  }
+
+  vmaDefragmentationEnd(device->getAllocator(), pendingContext);
+  passPending = false;
+  pendingAllocations.clear();
+
+  // Frames prepared after the buffer was freed may still have used it
+  for (int i = 0; i < pendingDeleters.size(); i++) {
+    device->getDeletionQueue()->defer(std::move(pendingDeleters[i]));
+  }
+  pendingDeleters.clear();
+  return true;
+}
+
+void VulkanDefragmenter::update() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!finishPass(false)) {
+    return;
+  }
+
+  if (!fragmented || buffers.empty()) {
+    return;
+  }
+  if (bytesMoved == 0 && allocationsMoved == 0) {
+    statsBefore = getFragmentationStats();
+  }
+
+  if (runPass()) {
+    return;
+  }
+
+  fragmented = false;
+  if (allocationsMoved > 0) {
+    FragmentationStats statsAfter = getFragmentationStats();
+    spdlog::info("gpu memory defragmented, moved {0} allocations and {1} "
+                 "bytes, fragmentation {2:.2f} to {3:.2f}, blocks {4} to {5}",
+                 allocationsMoved, bytesMoved, statsBefore.getFragmentation(),
+                 statsAfter.getFragmentation(), statsBefore.blockCount,
+                 statsAfter.blockCount);
+  }
+  bytesMoved = 0;
+  allocationsMoved = 0;
+}
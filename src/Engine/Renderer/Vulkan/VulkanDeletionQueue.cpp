@@ -0,0 +1,87 @@
+#include "Engine/Renderer/Vulkan/VulkanDeletionQueue.h"
+
+VulkanDeletionQueue::VulkanDeletionQueue(VulkanTimeline *timeline) {
+  this->timeline = timeline;
+}
+
+VulkanDeletionQueue::~VulkanDeletionQueue() { flush(); }
+
+void VulkanDeletionQueue::defer(std::function<void()> deleter) {
+  std::lock_guard<std::mutex> lock(mutex);
+  currentFrame.push_back(std::move(deleter));
+}
+
+void VulkanDeletionQueue::defer(uint64_t value,
+                                std::function<void()> deleter) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<std::function<void()>> deleters;
+  deleters.push_back(std::move(deleter));
+  insertPending(value, std::move(deleters));
+}
+
+void VulkanDeletionQueue::insertPending(
+    uint64_t value, std::vector<std::function<void()>> deleters) {
+  // Uploads submitted from loader threads can land behind a frame value
+  auto position = pendingFrames.end();
+  while (position != pendingFrames.begin() && (position - 1)->first > value) {
+    position--;
+  }
+  pendingFrames.insert(position, std::make_pair(value, std::move(deleters)));
+}
+
+void VulkanDeletionQueue::endFrame(uint64_t value) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (currentFrame.empty()) {
+    return;
+  }
+
+  insertPending(value, std::move(currentFrame));
+  currentFrame.clear();
+}
+
+void VulkanDeletionQueue::collect() {
+  uint64_t completedValue = timeline->getCompletedValue();
+  std::vector<std::function<void()>> ready;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!pendingFrames.empty() &&
+           pendingFrames.front().first <= completedValue) {
+      std::vector<std::function<void()>> &deleters =
+          pendingFrames.front().second;
+      ready.insert(ready.end(), std::make_move_iterator(deleters.begin()),
+                   std::make_move_iterator(deleters.end()));
+      pendingFrames.pop_front();
+    }
+  }
+
+  for (int i = 0; i < ready.size(); i++) {
+    ready[i]();
+  }
+
+  if (!ready.empty()) {
+    spdlog::debug("retired {0} deferred vulkan objects", ready.size());
+  }
+}
+
+void VulkanDeletionQueue::flush() {
+  timeline->wait(timeline->getLastSubmittedValue());
+
+  std::vector<std::function<void()>> ready;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &pending : pendingFrames) {
+      ready.insert(ready.end(), std::make_move_iterator(pending.second.begin()),
+                   std::make_move_iterator(pending.second.end()));
+    }
+    ready.insert(ready.end(), std::make_move_iterator(currentFrame.begin()),
+                 std::make_move_iterator(currentFrame.end()));
+    pendingFrames.clear();
+    currentFrame.clear();
+  }
+
+  for (int i = 0; i < ready.size(); i++) {
+    ready[i]();
+  }
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Renderer/Vulkan/VulkanDefragmenter.h"
+#include "Engine/Renderer/Vulkan/VulkanUtils.h"
 
 uint32_t VulkanDevice::getQueueFamilyIndex(VkQueueFlagBits queueFlags) {
   if (queueFlags & VK_QUEUE_COMPUTE_BIT) {
@@ -93,10 +95,42 @@ VulkanDevice::VulkanDevice(VkInstance instance,
 }
 
 VulkanDevice::~VulkanDevice() {
+  // Ends a pass still in flight before its moved allocations are freed
+  delete defragmenter;
+  // Runs every outstanding deleter while the allocator is still alive
+  delete deletionQueue;
+  delete timeline;
+  // Pipelines using these layouts were destroyed with the deletion queue
+  delete layoutCache;
+  delete variantLog;
+  delete renderPassCache;
+  // Views of released images went with the deletion queue, what is left
+  // belongs to images that outlived the device
+  delete imageViewCache;
+  delete samplerCache;
+  delete memoryStats;
+
+  if (memoryPools != nullptr) {
+    memoryPools->logStats();
+    delete memoryPools;
+  }
+
   if (allocator) {
     vmaDestroyAllocator(allocator);
   }
 
+  if (pipelineCache) {
+    vkDestroyPipelineCache(logicalDevice, pipelineCache, nullptr);
+  }
+
+  for (auto &transferPool : transferCommandPools) {
+    vkDestroyCommandPool(logicalDevice, transferPool.second.pool, nullptr);
+  }
+
+  if (computeCommandPool && computeCommandPool != commandPool) {
+    vkDestroyCommandPool(logicalDevice, computeCommandPool, nullptr);
+  }
+
   if (commandPool) {
     vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
   }
@@ -171,8 +205,37 @@ VulkanDevice::createLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
   deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
   deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
+  // The extension is only usable on a 1.0 instance when features can be
+  // chained through VK_KHR_get_physical_device_properties2
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+  if (extensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) &&
+      checkInstanceExtensionSupport(
+          VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+    timelineFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    timelineFeatures.pNext = pNextChain;
+    pNextChain = &timelineFeatures;
+
+    deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    enableTimelineSemaphores = true;
+  }
+
+  if (extensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) &&
+      checkInstanceExtensionSupport(
+          VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+    deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    enableMemoryBudget = true;
+  }
+
+  // Core in 1.2, the instance targets 1.0
+  if (extensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+    deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    enableDrawIndirectCount = true;
+  }
+
+  VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
   if (pNextChain) {
-    VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
     physicalDeviceFeatures2.sType =
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     physicalDeviceFeatures2.features = enabledFeatures;
@@ -197,6 +260,9 @@ VulkanDevice::createLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
   if (result == VK_SUCCESS) {
     spdlog::info("vulkan device initalized successfully");
     commandPool = createCommandPool(queueFamilyIndices.graphics);
+    computeCommandPool = hasAsyncCompute()
+                             ? createCommandPool(queueFamilyIndices.compute)
+                             : commandPool;
   } else {
     spdlog::error("vulkan device failed to initialize");
   }
@@ -205,6 +271,12 @@ VulkanDevice::createLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
 
   vkGetDeviceQueue(logicalDevice, queueFamilyIndices.graphics, 0,
                    &graphicsQueue);
+  vkGetDeviceQueue(logicalDevice, queueFamilyIndices.compute, 0,
+                   &computeQueue);
+  if (hasAsyncCompute()) {
+    spdlog::info("using async compute queue family {0}",
+                 queueFamilyIndices.compute);
+  }
 
   return result;
 }
@@ -215,19 +287,188 @@ void VulkanDevice::initAllocator() {
   allocatorInfo.device = logicalDevice;
   allocatorInfo.instance = instance;
 
+  if (enableMemoryBudget) {
+    allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+  }
+
   if (vmaCreateAllocator(&allocatorInfo, &allocator) != VK_SUCCESS) {
     spdlog::error("failed to create vulkan memory allocator");
   } else {
     spdlog::debug("created vulkan memory allocator");
+    memoryPools = new VulkanMemoryPools(allocator);
+    memoryStats = new VulkanMemoryStats(this);
+  }
+}
+
+void VulkanDevice::initTimeline() {
+  timeline = new VulkanTimeline(logicalDevice, enableTimelineSemaphores);
+  deletionQueue = new VulkanDeletionQueue(timeline);
+}
+
+void VulkanDevice::initPipelineCache() {
+  layoutCache = new VulkanPipelineLayoutCache(logicalDevice);
+  variantLog = new VulkanPipelineVariantLog();
+  renderPassCache = new VulkanRenderPassCache(logicalDevice);
+
+  VkPipelineCacheCreateInfo createInfo = {};
+  createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+  if (vkCreatePipelineCache(logicalDevice, &createInfo, nullptr,
+                            &pipelineCache) != VK_SUCCESS) {
+    spdlog::error("failed to create vulkan pipeline cache");
+  } else {
+    spdlog::debug("created vulkan pipeline cache");
   }
 }
 
+void VulkanDevice::initResourceCaches() {
+  samplerCache = new VulkanSamplerCache(
+      logicalDevice, properties.limits.maxSamplerAllocationCount);
+  imageViewCache = new VulkanImageViewCache(logicalDevice, deletionQueue);
+  defragmenter = new VulkanDefragmenter(this);
+}
+
 VmaAllocator VulkanDevice::getAllocator() { return allocator; }
 
+VulkanMemoryPools *VulkanDevice::getMemoryPools() { return memoryPools; }
+
+VulkanDefragmenter *VulkanDevice::getDefragmenter() { return defragmenter; }
+
+VulkanMemoryStats *VulkanDevice::getMemoryStats() { return memoryStats; }
+
+bool VulkanDevice::isMemoryBudgetEnabled() { return enableMemoryBudget; }
+
+bool VulkanDevice::isDrawIndirectCountEnabled() {
+  return enableDrawIndirectCount;
+}
+
+VulkanTimeline *VulkanDevice::getTimeline() { return timeline; }
+
+VulkanDeletionQueue *VulkanDevice::getDeletionQueue() { return deletionQueue; }
+
+void VulkanDevice::getMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget) {
+  VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+  vmaGetBudget(allocator, budgets);
+
+  usage = 0;
+  budget = 0;
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    if (memoryProperties.memoryHeaps[i].flags &
+        VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+      usage += budgets[i].usage;
+      budget += budgets[i].budget;
+    }
+  }
+}
+
 VkCommandPool VulkanDevice::getCommandPool() { return commandPool; }
 
+VkCommandPool VulkanDevice::getComputeCommandPool() {
+  return computeCommandPool;
+}
+
+VkCommandBuffer VulkanDevice::beginTransferCommands() {
+  VkCommandPool pool;
+  std::vector<VkCommandBuffer> retired;
+  {
+    std::lock_guard<std::mutex> lock(transferPoolMutex);
+    TransferCommandPool &transferPool =
+        transferCommandPools[std::this_thread::get_id()];
+    if (transferPool.pool == VK_NULL_HANDLE) {
+      transferPool.pool = createCommandPool(
+          queueFamilyIndices.graphics, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+    }
+    pool = transferPool.pool;
+    retired.swap(transferPool.retired);
+  }
+
+  if (!retired.empty()) {
+    vkFreeCommandBuffers(logicalDevice, pool,
+                         static_cast<uint32_t>(retired.size()), retired.data());
+  }
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = pool;
+  allocInfo.commandBufferCount = 1;
+
+  VkCommandBuffer commandBuffer;
+  vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+  return commandBuffer;
+}
+
+uint64_t VulkanDevice::submitTransferCommands(VkCommandBuffer commandBuffer) {
+  vkEndCommandBuffer(commandBuffer);
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+
+  uint64_t value = timeline->submit(graphicsQueue, submitInfo);
+
+  // The deleter runs on whichever thread collects, the pool's own thread
+  // frees the buffer the next time it records
+  std::thread::id owner = std::this_thread::get_id();
+  deletionQueue->defer(value, [this, owner, commandBuffer]() {
+    std::lock_guard<std::mutex> lock(transferPoolMutex);
+    transferCommandPools[owner].retired.push_back(commandBuffer);
+  });
+  return value;
+}
+
+VkPipelineCache VulkanDevice::getPipelineCache() { return pipelineCache; }
+
+VulkanPipelineLayoutCache *VulkanDevice::getLayoutCache() { return layoutCache; }
+
+VulkanPipelineVariantLog *VulkanDevice::getVariantLog() { return variantLog; }
+
+VulkanRenderPassCache *VulkanDevice::getRenderPassCache() {
+  return renderPassCache;
+}
+
+VulkanSamplerCache *VulkanDevice::getSamplerCache() { return samplerCache; }
+
+VulkanImageViewCache *VulkanDevice::getImageViewCache() {
+  return imageViewCache;
+}
+
 VkPhysicalDevice VulkanDevice::getPhysicalDevice() { return physicalDevice; }
 
+VkPhysicalDeviceProperties VulkanDevice::getProperties() { return properties; }
+
+VkPhysicalDeviceMemoryProperties VulkanDevice::getMemoryProperties() {
+  return memoryProperties;
+}
+
+VkPhysicalDeviceFeatures VulkanDevice::getFeatures() { return features; }
+
+VkPhysicalDeviceFeatures VulkanDevice::getEnabledFeatures() {
+  return enabledFeatures;
+}
+
+bool VulkanDevice::supportsFormat(VkFormat format,
+                                  VkFormatFeatureFlags featureFlags) {
+  VkFormatProperties formatProperties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format,
+                                      &formatProperties);
+  return (formatProperties.optimalTilingFeatures & featureFlags) ==
+         featureFlags;
+}
+
 VkDevice VulkanDevice::getDevice() { return logicalDevice; }
 
 VkQueue VulkanDevice::getGraphicsQueue() { return graphicsQueue; }
+
+VkQueue VulkanDevice::getComputeQueue() { return computeQueue; }
+
+bool VulkanDevice::hasAsyncCompute() {
+  return queueFamilyIndices.compute != queueFamilyIndices.graphics;
+}
@@ -1,12 +1,17 @@
 #include "Engine/Renderer/Vulkan/VulkanImage.h"
 
+#include <algorithm>
+
 VulkanImage::VulkanImage(VulkanDevice *device, int width, int height,
+                         VkFormat format, uint32_t mipLevels,
                          VkImageUsageFlags imageUsage,
                          VmaMemoryUsage memoryUsage,
-                         VmaAllocationCreateFlags flags) {
+                         VmaAllocationCreateFlags flags, MEMORY_POOL pool) {
   this->device = device;
   this->width = width;
   this->height = height;
+  this->format = format;
+  this->mipLevels = mipLevels;
 
   VkImageCreateInfo imageInfo = {};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -14,9 +19,9 @@ VulkanImage::VulkanImage(VulkanDevice *device, int width, int height,
   imageInfo.extent.width = static_cast<uint32_t>(width);
   imageInfo.extent.height = static_cast<uint32_t>(height);
   imageInfo.extent.depth = 1;
-  imageInfo.mipLevels = 1;
+  imageInfo.mipLevels = mipLevels;
   imageInfo.arrayLayers = 1;
-  imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+  imageInfo.format = format;
   imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
   imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
   imageInfo.usage = imageUsage;
@@ -26,6 +31,7 @@ VulkanImage::VulkanImage(VulkanDevice *device, int width, int height,
   VmaAllocationCreateInfo memoryInfo{};
   memoryInfo.flags = flags;
   memoryInfo.usage = memoryUsage;
+  memoryInfo.pool = device->getMemoryPools()->getPool(pool);
 
   VmaAllocationInfo allocationInfo = {};
 
@@ -33,33 +39,47 @@ VulkanImage::VulkanImage(VulkanDevice *device, int width, int height,
       vmaCreateImage(device->getAllocator(), &imageInfo, &memoryInfo, &image,
                      &allocation, &allocationInfo);
 
+  // Some formats need a memory type the pool was not created in
+  if (result != VK_SUCCESS && memoryInfo.pool != VK_NULL_HANDLE) {
+    spdlog::debug("{0} memory pool cannot hold {1}x{2} image",
+                  VulkanMemoryPools::getPoolName(pool), width, height);
+    memoryInfo.pool = VK_NULL_HANDLE;
+    result = vmaCreateImage(device->getAllocator(), &imageInfo, &memoryInfo,
+                            &image, &allocation, &allocationInfo);
+  }
+
   if (result != VK_SUCCESS) {
-    spdlog::error("failed to create vulkan image");
+    spdlog::error("failed to create {0}x{1} vulkan image", width, height);
   } else {
     memory = allocationInfo.deviceMemory;
+    allocationSize = allocationInfo.size;
+    device->getMemoryStats()->recordAllocation(allocationSize);
   }
 }
 
 VulkanImage::~VulkanImage() {
   if (image != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE) {
-    vmaDestroyImage(device->getAllocator(), image, allocation);
-  }
-}
-
-void VulkanImage::transitionLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
-  VkCommandBufferAllocateInfo allocInfo = {};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = device->getCommandPool();
-  allocInfo.commandBufferCount = 1;
+    device->getImageViewCache()->releaseImage(image);
+    device->getMemoryStats()->recordFree(allocationSize);
 
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device->getDevice(), &allocInfo, &commandBuffer);
+    VmaAllocator allocator = device->getAllocator();
+    VkImage image = this->image;
+    VmaAllocation allocation = this->allocation;
 
-  VkCommandBufferBeginInfo beginInfo = {};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    device->getDeletionQueue()->defer([allocator, image, allocation]() {
+      vmaDestroyImage(allocator, image, allocation);
+    });
+  }
+}
 
+void VulkanImage::recordBarrier(VkCommandBuffer commandBuffer,
+                                uint32_t baseMip, uint32_t levelCount,
+                                VkImageLayout oldLayout,
+                                VkImageLayout newLayout,
+                                VkAccessFlags srcAccess,
+                                VkAccessFlags dstAccess,
+                                VkPipelineStageFlags srcStage,
+                                VkPipelineStageFlags dstStage) {
   VkImageMemoryBarrier barrier = {};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   barrier.oldLayout = oldLayout;
@@ -68,78 +88,203 @@ void VulkanImage::transitionLayout(VkFormat format, VkImageLayout oldLayout, VkI
   barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   barrier.image = image;
   barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseMipLevel = baseMip;
+  barrier.subresourceRange.levelCount = levelCount;
   barrier.subresourceRange.baseArrayLayer = 0;
   barrier.subresourceRange.layerCount = 1;
+  barrier.srcAccessMask = srcAccess;
+  barrier.dstAccessMask = dstAccess;
 
-  // TODO
-  barrier.srcAccessMask = 0;
-  barrier.dstAccessMask = 0;
+  vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+}
 
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+void VulkanImage::recordMipChain(VkCommandBuffer commandBuffer,
+                                 uint32_t firstLevel) {
+  int32_t mipWidth = std::max(1, width >> (firstLevel - 1));
+  int32_t mipHeight = std::max(1, height >> (firstLevel - 1));
 
-  vkCmdPipelineBarrier(commandBuffer, 0, 0, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  for (uint32_t level = firstLevel; level < mipLevels; level++) {
+    recordBarrier(commandBuffer, level - 1, 1,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                  VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-  VkSubmitInfo submitInfo = {};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
+    VkImageBlit blit = {};
+    blit.srcOffsets[0] = {0, 0, 0};
+    blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.mipLevel = level - 1;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {std::max(1, mipWidth / 2), std::max(1, mipHeight / 2),
+                          1};
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.mipLevel = level;
+    blit.dstSubresource.baseArrayLayer = 0;
+    blit.dstSubresource.layerCount = 1;
 
-  vkEndCommandBuffer(commandBuffer);
+    vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                   VK_FILTER_LINEAR);
 
-  vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(device->getGraphicsQueue());
+    recordBarrier(commandBuffer, level - 1, 1,
+                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    mipWidth = std::max(1, mipWidth / 2);
+    mipHeight = std::max(1, mipHeight / 2);
+  }
 
-  vkFreeCommandBuffers(device->getDevice(), device->getCommandPool(), 1,
-                       &commandBuffer);
+  recordBarrier(commandBuffer, mipLevels - 1, 1,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 }
 
-void VulkanImage::transferFromBuffer(VulkanBuffer* buffer) {
-  transitionLayout(VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-  VkCommandBufferAllocateInfo allocInfo = {};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = device->getCommandPool();
-  allocInfo.commandBufferCount = 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device->getDevice(), &allocInfo, &commandBuffer);
-
-  VkCommandBufferBeginInfo beginInfo = {};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  VkBufferImageCopy region{};
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
-
-  region.imageOffset = {0, 0, 0};
-  region.imageExtent = {
-    width,
-    height,
-    1
-  };
-
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-  vkCmdCopyBufferToImage(commandBuffer, buffer->getBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-  vkEndCommandBuffer(commandBuffer);
-
-  VkSubmitInfo submitInfo = {};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
-
-  vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(device->getGraphicsQueue());
-
-  vkFreeCommandBuffers(device->getDevice(), device->getCommandPool(), 1,
-                       &commandBuffer);
-}
\ No newline at end of file
+uint64_t VulkanImage::upload(VulkanBuffer *buffer,
+                             const std::vector<VkBufferImageCopy> &regions,
+                             uint32_t uploadedLevels, bool generateMips) {
+  VkCommandBuffer commandBuffer = device->beginTransferCommands();
+
+  recordBarrier(commandBuffer, 0, mipLevels, VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  vkCmdCopyBufferToImage(commandBuffer, buffer->getBuffer(), image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         static_cast<uint32_t>(regions.size()), regions.data());
+
+  if (generateMips && uploadedLevels < mipLevels) {
+    // The last uploaded level is the source of the first generated one
+    if (uploadedLevels > 1) {
+      recordBarrier(commandBuffer, 0, uploadedLevels - 1,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+    recordMipChain(commandBuffer, uploadedLevels);
+  } else {
+    recordBarrier(commandBuffer, 0, mipLevels,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  }
+
+  return device->submitTransferCommands(commandBuffer);
+}
+
+uint64_t VulkanImage::streamFrom(VulkanBuffer *buffer,
+                                 const std::vector<VkBufferImageCopy> &regions,
+                                 VulkanImage *source, uint32_t sourceLevel,
+                                 uint32_t targetLevel, uint32_t levelCount) {
+  VkCommandBuffer commandBuffer = device->beginTransferCommands();
+
+  recordBarrier(commandBuffer, 0, mipLevels, VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  if (buffer != nullptr && !regions.empty()) {
+    vkCmdCopyBufferToImage(commandBuffer, buffer->getBuffer(), image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()),
+                           regions.data());
+  }
+
+  if (source != nullptr && levelCount > 0) {
+    // Frames still sampling the source are ordered before this on the queue
+    source->recordBarrier(commandBuffer, sourceLevel, levelCount,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    std::vector<VkImageCopy> copies;
+    for (uint32_t i = 0; i < levelCount; i++) {
+      VkImageCopy copy = {};
+      copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      copy.srcSubresource.mipLevel = sourceLevel + i;
+      copy.srcSubresource.baseArrayLayer = 0;
+      copy.srcSubresource.layerCount = 1;
+      copy.dstSubresource = copy.srcSubresource;
+      copy.dstSubresource.mipLevel = targetLevel + i;
+      copy.extent.width = static_cast<uint32_t>(std::max(1, width >> (targetLevel + i)));
+      copy.extent.height = static_cast<uint32_t>(std::max(1, height >> (targetLevel + i)));
+      copy.extent.depth = 1;
+      copies.push_back(copy);
+    }
+
+    vkCmdCopyImage(commandBuffer, source->getImage(),
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   static_cast<uint32_t>(copies.size()), copies.data());
+
+    source->recordBarrier(commandBuffer, sourceLevel, levelCount,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  }
+
+  recordBarrier(commandBuffer, 0, mipLevels,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+  return device->submitTransferCommands(commandBuffer);
+}
+
+bool VulkanImage::canGenerateMips(VulkanDevice *device, VkFormat format) {
+  return device->supportsFormat(
+      format, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+}
+
+VkImage VulkanImage::getImage() { return image; }
+
+VkImageView VulkanImage::getView(VkImageAspectFlags aspectMask) {
+  VkImageViewCreateInfo viewInfo = {};
+  viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  viewInfo.image = image;
+  viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  viewInfo.format = format;
+  viewInfo.components = {VK_COMPONENT_SWIZZLE_IDENTITY,
+                         VK_COMPONENT_SWIZZLE_IDENTITY,
+                         VK_COMPONENT_SWIZZLE_IDENTITY,
+                         VK_COMPONENT_SWIZZLE_IDENTITY};
+  viewInfo.subresourceRange.aspectMask = aspectMask;
+  viewInfo.subresourceRange.baseMipLevel = 0;
+  viewInfo.subresourceRange.levelCount = mipLevels;
+  viewInfo.subresourceRange.baseArrayLayer = 0;
+  viewInfo.subresourceRange.layerCount = 1;
+
+  return device->getImageViewCache()->getImageView(viewInfo);
+}
+
+int VulkanImage::getWidth() { return width; }
+
+int VulkanImage::getHeight() { return height; }
+
+VkFormat VulkanImage::getFormat() { return format; }
+
+uint32_t VulkanImage::getMipLevels() { return mipLevels; }
+
+VkDeviceSize VulkanImage::getAllocationSize() { return allocationSize; }
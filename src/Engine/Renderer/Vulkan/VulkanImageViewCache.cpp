@@ -0,0 +1,114 @@
+#include "Engine/Renderer/Vulkan/VulkanImageViewCache.h"
+
+static uint64_t getImageKey(VkImage image) {
+  return hashBytes(&image, sizeof(image));
+}
+
+VulkanImageViewCache::ImageViewKey VulkanImageViewCache::getImageViewKey(
+    const VkImageViewCreateInfo &createInfo) {
+  const VkImageSubresourceRange &range = createInfo.subresourceRange;
+  ImageViewKey fields = {reinterpret_cast<uint64_t>(createInfo.image),
+                         createInfo.flags,
+                         static_cast<uint64_t>(createInfo.viewType),
+                         static_cast<uint64_t>(createInfo.format),
+                         static_cast<uint64_t>(createInfo.components.r),
+                         static_cast<uint64_t>(createInfo.components.g),
+                         static_cast<uint64_t>(createInfo.components.b),
+                         static_cast<uint64_t>(createInfo.components.a),
+                         range.aspectMask,
+                         range.baseMipLevel,
+                         range.levelCount,
+                         range.baseArrayLayer,
+                         range.layerCount};
+  return fields;
+}
+
+VulkanImageViewCache::VulkanImageViewCache(VkDevice device,
+                                           VulkanDeletionQueue *deletionQueue) {
+  this->device = device;
+  this->deletionQueue = deletionQueue;
+}
+
+VulkanImageViewCache::~VulkanImageViewCache() {
+  imageViews.forEach(
+      [this](uint64_t hash, std::vector<CachedImageView> &cached) {
+        for (int i = 0; i < cached.size(); i++) {
+          vkDestroyImageView(device, cached[i].imageView, nullptr);
+        }
+      });
+}
+
+VkImageView
+VulkanImageViewCache::getImageView(const VkImageViewCreateInfo &createInfo) {
+  ImageViewKey key = getImageViewKey(createInfo);
+  uint64_t hash = hashBytes(key.data(), sizeof(key));
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::vector<CachedImageView> &cached = imageViews.insert(hash);
+  for (int i = 0; i < cached.size(); i++) {
+    if (cached[i].key == key) {
+      return cached[i].imageView;
+    }
+  }
+
+  VkImageView imageView;
+  if (vkCreateImageView(device, &createInfo, nullptr, &imageView) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to create vulkan image view");
+    return VK_NULL_HANDLE;
+  }
+
+  cached.push_back({key, imageView});
+  imageRefs.insert(getImageKey(createInfo.image))
+      .push_back({createInfo.image, hash});
+  return imageView;
+}
+
+void VulkanImageViewCache::releaseImage(VkImage image) {
+  uint64_t imageHandle = reinterpret_cast<uint64_t>(image);
+  std::vector<VkImageView> released;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<ImageViewRef> *refs = imageRefs.find(getImageKey(image));
+    if (refs == nullptr) {
+      return;
+    }
+
+    // Other images may share the bucket, only this image's views go
+    for (int i = 0; i < refs->size();) {
+      if ((*refs)[i].image != image) {
+        i++;
+        continue;
+      }
+
+      std::vector<CachedImageView> *cached = imageViews.find((*refs)[i].hash);
+      for (int j = 0; cached != nullptr && j < cached->size();) {
+        if ((*cached)[j].key[0] == imageHandle) {
+          released.push_back((*cached)[j].imageView);
+          (*cached)[j] = cached->back();
+          cached->pop_back();
+        } else {
+          j++;
+        }
+      }
+      if (cached != nullptr && cached->empty()) {
+        imageViews.erase((*refs)[i].hash);
+      }
+
+      (*refs)[i] = refs->back();
+      refs->pop_back();
+    }
+    if (refs->empty()) {
+      imageRefs.erase(getImageKey(image));
+    }
+  }
+
+  VkDevice device = this->device;
+  deletionQueue->defer([device, released]() {
+    for (int i = 0; i < released.size(); i++) {
+      vkDestroyImageView(device, released[i], nullptr);
+    }
+  });
+}
@@ -0,0 +1,165 @@
+#include "Engine/Renderer/Vulkan/VulkanMemoryPools.h"
+
+static const char *POOL_NAMES[MEMORY_POOL_COUNT] = {"default", "frame",
+                                                    "staging", "mesh",
+                                                    "texture"};
+
+VulkanMemoryPools::VulkanMemoryPools(VmaAllocator allocator) {
+  this->allocator = allocator;
+
+  pools[MEMORY_POOL_FRAME] = createBufferPool(
+      MEMORY_POOL_FRAME,
+      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+      VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT,
+      FRAME_POOL_SIZE, 1);
+  pools[MEMORY_POOL_STAGING] = createBufferPool(
+      MEMORY_POOL_STAGING, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VMA_MEMORY_USAGE_CPU_ONLY, 0, STAGING_POOL_SIZE, 1);
+  pools[MEMORY_POOL_MESH] = createBufferPool(
+      MEMORY_POOL_MESH,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VMA_MEMORY_USAGE_GPU_ONLY, 0, MESH_POOL_BLOCK_SIZE, 0);
+  pools[MEMORY_POOL_TEXTURE] = createImagePool(
+      MEMORY_POOL_TEXTURE,
+      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+          VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+      TEXTURE_POOL_BLOCK_SIZE);
+}
+
+VulkanMemoryPools::~VulkanMemoryPools() {
+  for (int i = 0; i < MEMORY_POOL_COUNT; i++) {
+    if (pools[i] != VK_NULL_HANDLE) {
+      vmaDestroyPool(allocator, pools[i]);
+    }
+  }
+}
+
+VmaPool VulkanMemoryPools::createBufferPool(MEMORY_POOL pool,
+                                            VkBufferUsageFlags usage,
+                                            VmaMemoryUsage memoryUsage,
+                                            VmaPoolCreateFlags flags,
+                                            VkDeviceSize blockSize,
+                                            size_t maxBlockCount) {
+  // Memory type of a representative buffer, buffers with other usage flags
+  // end up in the same type on every implementation we target
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = 1024;
+  bufferInfo.usage = usage;
+
+  VmaAllocationCreateInfo allocationInfo = {};
+  allocationInfo.usage = memoryUsage;
+
+  VmaPoolCreateInfo poolInfo = {};
+  if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &bufferInfo,
+                                          &allocationInfo,
+                                          &poolInfo.memoryTypeIndex) !=
+      VK_SUCCESS) {
+    spdlog::error("no memory type for the {0} memory pool", getPoolName(pool));
+    return VK_NULL_HANDLE;
+  }
+  poolInfo.flags = flags;
+  poolInfo.blockSize = blockSize;
+  // Bounded pools get all their blocks now instead of on first use
+  poolInfo.minBlockCount = maxBlockCount;
+  poolInfo.maxBlockCount = maxBlockCount;
+
+  VmaPool vmaPool;
+  if (vmaCreatePool(allocator, &poolInfo, &vmaPool) != VK_SUCCESS) {
+    spdlog::error("failed to create the {0} memory pool", getPoolName(pool));
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created the {0} memory pool in memory type {1}",
+                getPoolName(pool), poolInfo.memoryTypeIndex);
+  return vmaPool;
+}
+
+VmaPool VulkanMemoryPools::createImagePool(MEMORY_POOL pool,
+                                           VkImageUsageFlags usage,
+                                           VkDeviceSize blockSize) {
+  VkImageCreateInfo imageInfo = {};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+  imageInfo.extent = {256, 256, 1};
+  imageInfo.mipLevels = 1;
+  imageInfo.arrayLayers = 1;
+  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.usage = usage;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+  VmaAllocationCreateInfo allocationInfo = {};
+  allocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+  VmaPoolCreateInfo poolInfo = {};
+  if (vmaFindMemoryTypeIndexForImageInfo(allocator, &imageInfo,
+                                         &allocationInfo,
+                                         &poolInfo.memoryTypeIndex) !=
+      VK_SUCCESS) {
+    spdlog::error("no memory type for the {0} memory pool", getPoolName(pool));
+    return VK_NULL_HANDLE;
+  }
+  poolInfo.blockSize = blockSize;
+
+  VmaPool vmaPool;
+  if (vmaCreatePool(allocator, &poolInfo, &vmaPool) != VK_SUCCESS) {
+    spdlog::error("failed to create the {0} memory pool", getPoolName(pool));
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created the {0} memory pool in memory type {1}",
+                getPoolName(pool), poolInfo.memoryTypeIndex);
+  return vmaPool;
+}
+
+VmaPool VulkanMemoryPools::getPool(MEMORY_POOL pool) { return pools[pool]; }
+
+const char *VulkanMemoryPools::getPoolName(MEMORY_POOL pool) {
+  return POOL_NAMES[pool];
+}
+
+std::vector<MemoryPoolStats> VulkanMemoryPools::getPoolStats() {
+  std::vector<MemoryPoolStats> stats;
+  for (int i = 0; i < MEMORY_POOL_COUNT; i++) {
+    if (pools[i] == VK_NULL_HANDLE) {
+      continue;
+    }
+
+    VmaPoolStats poolStats = {};
+    vmaGetPoolStats(allocator, pools[i], &poolStats);
+
+    MemoryPoolStats entry;
+    entry.name = POOL_NAMES[i];
+    entry.size = poolStats.size;
+    entry.unusedSize = poolStats.unusedSize;
+    entry.allocationCount = poolStats.allocationCount;
+    entry.blockCount = poolStats.blockCount;
+    stats.push_back(entry);
+  }
+  return stats;
+}
+
+void VulkanMemoryPools::logStats() {
+  std::vector<MemoryPoolStats> poolStats = getPoolStats();
+  for (int i = 0; i < poolStats.size(); i++) {
+    const MemoryPoolStats &pool = poolStats[i];
+    spdlog::info("{0} memory pool: {1} allocations, {2} of {3} bytes used in "
+                 "{4} blocks",
+                 pool.name, pool.allocationCount,
+                 pool.size - pool.unusedSize, pool.size, pool.blockCount);
+  }
+
+  // Covers the custom pools as well as the default ones
+  VmaStats stats;
+  vmaCalculateStats(allocator, &stats);
+  spdlog::info("gpu memory: {0} allocations, {1} bytes used, {2} bytes "
+               "unused in {3} blocks",
+               stats.total.allocationCount, stats.total.usedBytes,
+               stats.total.unusedBytes, stats.total.blockCount);
+}
@@ -0,0 +1,153 @@
+#include "Engine/Renderer/Vulkan/VulkanMemoryStats.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "Engine/Renderer/Vulkan/VulkanDevice.h"
+#include "Engine/Resources/ResourceManager.h"
+
+static void writeRate(std::ofstream &file, const AllocationRate &rate) {
+  file << "{\"allocations\": " << rate.allocations
+       << ", \"frees\": " << rate.frees
+       << ", \"allocated_bytes\": " << rate.allocatedBytes
+       << ", \"freed_bytes\": " << rate.freedBytes << "}";
+}
+
+VulkanMemoryStats::VulkanMemoryStats(VulkanDevice *device) {
+  this->device = device;
+
+  VkPhysicalDeviceMemoryProperties memoryProperties =
+      device->getMemoryProperties();
+  heaps.resize(memoryProperties.memoryHeapCount);
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    heaps[i].size = memoryProperties.memoryHeaps[i].size;
+    heaps[i].flags = memoryProperties.memoryHeaps[i].flags;
+  }
+}
+
+void VulkanMemoryStats::recordAllocation(VkDeviceSize size) {
+  allocations++;
+  allocatedBytes += size;
+}
+
+void VulkanMemoryStats::recordFree(VkDeviceSize size) {
+  frees++;
+  freedBytes += size;
+}
+
+void VulkanMemoryStats::update() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  vmaSetCurrentFrameIndex(device->getAllocator(), ++frameIndex);
+
+  VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+  vmaGetBudget(device->getAllocator(), budgets);
+  for (int i = 0; i < heaps.size(); i++) {
+    heaps[i].usage = budgets[i].usage;
+    heaps[i].budget = budgets[i].budget;
+    heaps[i].peakUsage = std::max(heaps[i].peakUsage, heaps[i].usage);
+  }
+
+  lastFrame.allocations = allocations.exchange(0);
+  lastFrame.frees = frees.exchange(0);
+  lastFrame.allocatedBytes = allocatedBytes.exchange(0);
+  lastFrame.freedBytes = freedBytes.exchange(0);
+
+  peakFrame.allocations = std::max(peakFrame.allocations, lastFrame.allocations);
+  peakFrame.frees = std::max(peakFrame.frees, lastFrame.frees);
+  peakFrame.allocatedBytes =
+      std::max(peakFrame.allocatedBytes, lastFrame.allocatedBytes);
+  peakFrame.freedBytes = std::max(peakFrame.freedBytes, lastFrame.freedBytes);
+}
+
+std::vector<HeapStats> VulkanMemoryStats::getHeapStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return heaps;
+}
+
+AllocationRate VulkanMemoryStats::getLastFrame() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lastFrame;
+}
+
+AllocationRate VulkanMemoryStats::getPeakFrame() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return peakFrame;
+}
+
+bool VulkanMemoryStats::writeSnapshot(const std::string &filepath) {
+  std::vector<HeapStats> heaps = getHeapStats();
+  AllocationRate lastFrame = getLastFrame();
+  AllocationRate peakFrame = getPeakFrame();
+
+  VmaStats stats;
+  vmaCalculateStats(device->getAllocator(), &stats);
+
+  std::vector<ResourceTypeStats> resourceTypes =
+      ResourceManager::getInstance()->getTypeStats();
+  std::vector<MemoryPoolStats> pools =
+      device->getMemoryPools()->getPoolStats();
+
+  std::ofstream file(filepath);
+  file << "{\n    \"frame\": " << frameIndex << ",\n";
+  file << "    \"budget_source\": \""
+       << (device->isMemoryBudgetEnabled() ? "VK_EXT_memory_budget"
+                                           : "estimate")
+       << "\",\n";
+
+  file << "    \"heaps\": [";
+  for (int i = 0; i < heaps.size(); i++) {
+    file << (i > 0 ? "," : "") << "\n        {\"size\": " << heaps[i].size
+         << ", \"device_local\": "
+         << ((heaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true"
+                                                                : "false")
+         << ", \"usage\": " << heaps[i].usage
+         << ", \"budget\": " << heaps[i].budget
+         << ", \"peak_usage\": " << heaps[i].peakUsage << "}";
+  }
+  file << (heaps.empty() ? "" : "\n    ") << "],\n";
+
+  file << "    \"totals\": {\"allocations\": " << stats.total.allocationCount
+       << ", \"blocks\": " << stats.total.blockCount
+       << ", \"used_bytes\": " << stats.total.usedBytes
+       << ", \"unused_bytes\": " << stats.total.unusedBytes << "},\n";
+
+  file << "    \"last_frame\": ";
+  writeRate(file, lastFrame);
+  file << ",\n    \"peak_frame\": ";
+  writeRate(file, peakFrame);
+  file << ",\n";
+
+  file << "    \"pools\": [";
+  for (int i = 0; i < pools.size(); i++) {
+    file << (i > 0 ? "," : "") << "\n        {\"name\": \"" << pools[i].name
+         << "\", \"allocations\": " << pools[i].allocationCount
+         << ", \"blocks\": " << pools[i].blockCount
+         << ", \"size\": " << pools[i].size
+         << ", \"unused_size\": " << pools[i].unusedSize << "}";
+  }
+  file << (pools.empty() ? "" : "\n    ") << "],\n";
+
+  file << "    \"resources\": [";
+  for (int i = 0; i < resourceTypes.size(); i++) {
+    file << (i > 0 ? "," : "") << "\n        {\"type\": \""
+         << getResourceTypeName(resourceTypes[i].type)
+         << "\", \"count\": " << resourceTypes[i].count
+         << ", \"cpu_bytes\": " << resourceTypes[i].cpuBytes
+         << ", \"gpu_bytes\": " << resourceTypes[i].gpuBytes << "}";
+  }
+  file << (resourceTypes.empty() ? "" : "\n    ") << "],\n";
+
+  // Already JSON, embedded as is
+  char *vmaStats = nullptr;
+  vmaBuildStatsString(device->getAllocator(), &vmaStats, VK_TRUE);
+  file << "    \"vma\": " << vmaStats << "\n}\n";
+  vmaFreeStatsString(device->getAllocator(), vmaStats);
+
+  if (!file) {
+    spdlog::error("failed to write gpu memory stats {0}", filepath);
+    return false;
+  }
+  spdlog::info("wrote gpu memory stats to {0}", filepath);
+  return true;
+}
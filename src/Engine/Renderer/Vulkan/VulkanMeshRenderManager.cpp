@@ -1,35 +1,42 @@
 #include "Engine/Renderer/Vulkan/VulkanMeshRenderManager.h"
 
-VulkanMeshRenderManager::VulkanMeshRenderManager(VulkanDevice *device, int maxObjects, int frameCount) {
-  std::shared_ptr<Resource> resource = ResourceManager::getInstance()->getResource("assets/shaders/test_vk_resource.json");
-  this->pipeline = std::static_pointer_cast<VulkanPipelineResource>(resource);
+VulkanMeshRenderManager::VulkanMeshRenderManager(VulkanDevice *device, VulkanAsyncCompute *asyncCompute, int maxObjects, int frameCount) {
+  this->pipelineHandle = ResourceManager::getInstance()->acquire(TEST_PIPELINE_RESOURCE);
   this->device = device;
+  this->asyncCompute = asyncCompute;
   this->maxObjects = maxObjects;
   this->frameCount = frameCount;
   initBuffers();
   initDescriptors();
+  initCulling();
 }
 
 VulkanMeshRenderManager::~VulkanMeshRenderManager() {
-  for (int i = 0; i < uniformBuffers.size(); i++) {
-    delete uniformBuffers[i];
+  for (int i = 0; i < cameraBuffers.size(); i++) {
+    delete cameraBuffers[i];
   }
-  uniformBuffers.clear();
+  cameraBuffers.clear();
 
   vkDestroyDescriptorPool(device->getDevice(), descriptorPools[0], nullptr);
+
+  if (cullingPass != nullptr) {
+    delete cullingPass;
+    ResourceManager::getInstance()->release(culledPipelineHandle);
+  }
+  ResourceManager::getInstance()->release(pipelineHandle);
 }
 
 void VulkanMeshRenderManager::initBuffers() {
-  uniformBuffers.resize(frameCount);
+  cameraBuffers.resize(frameCount);
 
-  for (int i = 0; i < uniformBuffers.size(); i++) {
-    uniformBuffers[i] = new VulkanDynamicBuffer<glm::mat4>(device, maxObjects);
+  for (int i = 0; i < cameraBuffers.size(); i++) {
+    cameraBuffers[i] = new VulkanBuffer(device, sizeof(CameraUniform), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_ALLOCATION_CREATE_MAPPED_BIT, MEMORY_POOL_FRAME);
   }
 }
 
 void VulkanMeshRenderManager::initDescriptors() {
   VkDescriptorPoolSize poolSize = {};
-  poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
   poolSize.descriptorCount = static_cast<uint32_t>(frameCount);
 
   VkDescriptorPoolCreateInfo poolInfo{};
@@ -38,7 +45,7 @@ void VulkanMeshRenderManager::initDescriptors() {
   poolInfo.pPoolSizes = &poolSize;
   poolInfo.maxSets = frameCount;
 
-  VkDescriptorPool descriptorPool;
+  VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
 
   if (vkCreateDescriptorPool(device->getDevice(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
     spdlog::error("failed to create vulkan descriptor pool");
@@ -48,6 +55,13 @@ void VulkanMeshRenderManager::initDescriptors() {
 
   descriptorPools.push_back(descriptorPool);
 
+  // Set layouts are shared by signature, so reloaded pipelines with the same
+  // interface bind these sets unchanged
+  VulkanPipelineResource* pipeline = ResourceManager::resolve(pipelineHandle);
+  if (pipeline == nullptr || descriptorPool == VK_NULL_HANDLE) {
+    spdlog::error("failed to load mesh pipeline {0}, meshes are not drawn", TEST_PIPELINE_RESOURCE.path);
+    return;
+  }
   std::vector<VkDescriptorSetLayout> setLayouts(frameCount, pipeline->getDescriptorSetLayout());
 
   VkDescriptorSetAllocateInfo allocInfo = {};
@@ -60,13 +74,15 @@ void VulkanMeshRenderManager::initDescriptors() {
 
   if (vkAllocateDescriptorSets(device->getDevice(), &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
     spdlog::error("failed to create vulkan descriptor sets");
+    descriptorSets.clear();
+    return;
   } else {
     spdlog::debug("created vulkan descriptor sets");
   }
 
   for (int i = 0; i < frameCount; i++) {
     VkDescriptorBufferInfo bufferInfo = {};
-    bufferInfo.buffer = uniformBuffers[i]->getBuffer();
+    bufferInfo.buffer = cameraBuffers[i]->getBuffer();
     bufferInfo.offset = 0;
     bufferInfo.range = VK_WHOLE_SIZE;
 
@@ -75,7 +91,7 @@ void VulkanMeshRenderManager::initDescriptors() {
     descriptorWrite.dstSet = descriptorSets[i];
     descriptorWrite.dstBinding = 0;
     descriptorWrite.dstArrayElement = 0;
-    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     descriptorWrite.descriptorCount = 1;
     descriptorWrite.pBufferInfo = &bufferInfo;
 
@@ -84,31 +100,91 @@ void VulkanMeshRenderManager::initDescriptors() {
 
 }
 
-void VulkanMeshRenderManager::draw(const VulkanRenderFrame& frame, const std::vector<Node*>& drawList) {
-  std::vector<std::shared_ptr<Resource>> meshes = ResourceManager::getInstance()->getResources(RESOURCE_VULKAN_MESH_INSTANCE);
+void VulkanMeshRenderManager::initCulling() {
+  if (!VulkanCullingPass::isSupported(device)) {
+    spdlog::info("indirect count draws unsupported, culling meshes on the cpu");
+    return;
+  }
 
-  vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipeline());
+  culledPipelineHandle = ResourceManager::getInstance()->acquire(CULLED_MESH_PIPELINE_RESOURCE);
+  VulkanPipelineResource* culledPipeline = ResourceManager::resolve(culledPipelineHandle);
+  if (culledPipeline == nullptr) {
+    spdlog::error("failed to load culled mesh pipeline {0}, culling meshes on the cpu", CULLED_MESH_PIPELINE_RESOURCE.path);
+    ResourceManager::getInstance()->release(culledPipelineHandle);
+    return;
+  }
+  cullingPass = new VulkanCullingPass(device, asyncCompute, maxObjects, frameCount, culledPipeline->getDescriptorSetLayout(), cameraBuffers);
+}
 
-  for (int i = 0; i < drawList.size(); i++) {
-    Actor* actor = (Actor*)drawList[i];
+void VulkanMeshRenderManager::prepare(VulkanRenderFrame& frame, const RenderSnapshot& snapshot) {
+  CameraUniform cameraUniform = {};
+  cameraUniform.viewProjection = snapshot.viewProjection;
+  cameraBuffers[frame.currentFrameIndex]->update(&cameraUniform, sizeof(CameraUniform), 0);
 
-    VkBuffer vertexBuffers[] = {actor->getMeshInstance()->getMesh()->getVertexBuffer()};
-    VkDeviceSize offsets[] = {0};
+  if (cullingPass != nullptr) {
+    cullingPass->cull(frame, snapshot);
+  }
+}
 
-    glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 1920.0f / 1080.0f, 0.1f, 10.0f);
-    proj[1][1] *= -1;
+void VulkanMeshRenderManager::drawCulled(const VulkanRenderFrame& frame) {
+  VulkanPipelineResource* pipeline = ResourceManager::resolve(culledPipelineHandle);
+  if (pipeline == nullptr) {
+    return;
+  }
 
-    glm::mat4 mvp = proj * view * actor->getTransform();
+  VkPipeline variant = pipeline->requestPipeline(PipelineState(), frame.renderPassKey);
+  if (variant == VK_NULL_HANDLE) {
+    return;
+  }
 
-    uniformBuffers[frame.currentFrameIndex]->update(actor->getMeshInstance()->getDescriptorIndex(), mvp);
+  vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, variant);
+  cullingPass->draw(frame, pipeline->getPipelineLayout());
+}
+
+void VulkanMeshRenderManager::draw(const VulkanRenderFrame& frame, const RenderSnapshot& snapshot) {
+  // Visible instances were compacted into indirect commands by prepare,
+  // one draw call per mesh instead of one per instance
+  if (cullingPass != nullptr) {
+    drawCulled(frame);
+    return;
+  }
+
+  VulkanPipelineResource* pipeline = ResourceManager::resolve(pipelineHandle);
+  if (pipeline == nullptr || descriptorSets.empty()) {
+    return;
+  }
+
+  // After a swapchain format change the variant for the new render pass is
+  // built in the background, meshes are skipped until it is ready
+  VkPipeline variant = pipeline->requestPipeline(PipelineState(), frame.renderPassKey);
+  if (variant == VK_NULL_HANDLE) {
+    return;
+  }
+
+  vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, variant);
+  vkCmdBindDescriptorSets(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipelineLayout(), 0, 1, &(descriptorSets[frame.currentFrameIndex]), 0, nullptr);
+
+  VkPushConstantRange pushConstantRange = pipeline->getPushConstantRange();
+
+  for (int i = 0; i < snapshot.meshDraws.size(); i++) {
+    const MeshDraw& meshDraw = snapshot.meshDraws[i];
+    // Entities whose mesh instance is not loaded draw nothing
+    VulkanMeshInstanceResource* meshInstance = ResourceManager::resolve(meshDraw.meshInstance);
+    VulkanMeshResource* mesh = meshInstance != nullptr ? meshInstance->getMesh() : nullptr;
+    if (mesh == nullptr) {
+      continue;
+    }
+
+    VkBuffer vertexBuffers[] = {mesh->getVertexBuffer()};
+    VkDeviceSize offsets[] = {0};
 
-    uint32_t dynamicOffset = static_cast<uint32_t>(uniformBuffers[frame.currentFrameIndex]->getDynamicAlignment() * actor->getMeshInstance()->getDescriptorIndex());
+    MeshPushConstants pushConstants = {};
+    pushConstants.model = meshDraw.model;
 
-    vkCmdBindDescriptorSets(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipelineLayout(), 0, 1, &(descriptorSets[frame.currentFrameIndex]), 1, &dynamicOffset);
+    vkCmdPushConstants(frame.commandBuffer, pipeline->getPipelineLayout(), pushConstantRange.stageFlags, pushConstantRange.offset, sizeof(MeshPushConstants), &pushConstants);
     vkCmdBindVertexBuffers(frame.commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(frame.commandBuffer, actor->getMeshInstance()->getMesh()->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindIndexBuffer(frame.commandBuffer, mesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
 
-    vkCmdDrawIndexed(frame.commandBuffer, static_cast<uint32_t>(actor->getMeshInstance()->getMesh()->getIndexCount()), 1, 0, 0, 0);
+    vkCmdDrawIndexed(frame.commandBuffer, static_cast<uint32_t>(mesh->getIndexCount()), 1, 0, 0, 0);
   }
 }
\ No newline at end of file
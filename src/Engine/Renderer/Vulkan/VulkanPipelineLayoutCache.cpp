@@ -0,0 +1,133 @@
+#include "Engine/Renderer/Vulkan/VulkanPipelineLayoutCache.h"
+
+#include <algorithm>
+
+VulkanPipelineLayoutCache::VulkanPipelineLayoutCache(VkDevice device) {
+  this->device = device;
+}
+
+VulkanPipelineLayoutCache::~VulkanPipelineLayoutCache() {
+  pipelineLayouts.forEach(
+      [this](uint64_t key, std::vector<CachedPipelineLayout> &layouts) {
+        for (int i = 0; i < layouts.size(); i++) {
+          vkDestroyPipelineLayout(device, layouts[i].layout, nullptr);
+        }
+      });
+  descriptorSetLayouts.forEach(
+      [this](uint64_t key, std::vector<CachedSetLayout> &layouts) {
+        for (int i = 0; i < layouts.size(); i++) {
+          vkDestroyDescriptorSetLayout(device, layouts[i].layout, nullptr);
+        }
+      });
+}
+
+VkDescriptorSetLayout VulkanPipelineLayoutCache::getDescriptorSetLayout(
+    std::vector<VkDescriptorSetLayoutBinding> bindings) {
+  std::sort(bindings.begin(), bindings.end(),
+            [](const auto &a, const auto &b) { return a.binding < b.binding; });
+
+  std::vector<uint32_t> signature;
+  for (int i = 0; i < bindings.size(); i++) {
+    signature.push_back(bindings[i].binding);
+    signature.push_back(bindings[i].descriptorType);
+    signature.push_back(bindings[i].descriptorCount);
+    signature.push_back(bindings[i].stageFlags);
+  }
+  uint64_t key =
+      hashBytes(signature.data(), signature.size() * sizeof(uint32_t));
+
+  std::vector<CachedSetLayout> &cached = descriptorSetLayouts.insert(key);
+  for (int i = 0; i < cached.size(); i++) {
+    if (cached[i].signature == signature) {
+      return cached[i].layout;
+    }
+  }
+
+  VkDescriptorSetLayoutCreateInfo createInfo = {};
+  createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  createInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+  createInfo.pBindings = bindings.data();
+
+  VkDescriptorSetLayout layout;
+  if (vkCreateDescriptorSetLayout(device, &createInfo, nullptr, &layout) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to create vulkan descriptor set layout");
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created vulkan descriptor set layout");
+  cached.push_back({signature, layout});
+  return layout;
+}
+
+std::vector<VkDescriptorSetLayout>
+VulkanPipelineLayoutCache::getDescriptorSetLayouts(
+    const ShaderReflection &reflection) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::vector<VkDescriptorSetLayout> setLayouts;
+  for (uint32_t set = 0; set < reflection.getSetCount(); set++) {
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    for (int i = 0; i < reflection.bindings.size(); i++) {
+      const ShaderBinding &shaderBinding = reflection.bindings[i];
+      if (shaderBinding.set != set) {
+        continue;
+      }
+
+      VkDescriptorSetLayoutBinding binding = {};
+      binding.binding = shaderBinding.binding;
+      binding.descriptorType = shaderBinding.descriptorType;
+      binding.descriptorCount = shaderBinding.descriptorCount;
+      binding.stageFlags = shaderBinding.stageFlags;
+      bindings.push_back(binding);
+    }
+    setLayouts.push_back(getDescriptorSetLayout(bindings));
+  }
+  return setLayouts;
+}
+
+VkPipelineLayout VulkanPipelineLayoutCache::getPipelineLayout(
+    const std::vector<VkDescriptorSetLayout> &setLayouts,
+    const std::vector<VkPushConstantRange> &pushConstantRanges) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Set layouts are deduplicated already, so their handles identify them
+  std::vector<uint64_t> signature;
+  for (int i = 0; i < setLayouts.size(); i++) {
+    signature.push_back(reinterpret_cast<uint64_t>(setLayouts[i]));
+  }
+  for (int i = 0; i < pushConstantRanges.size(); i++) {
+    signature.push_back(pushConstantRanges[i].stageFlags);
+    signature.push_back((static_cast<uint64_t>(pushConstantRanges[i].offset)
+                         << 32) |
+                        pushConstantRanges[i].size);
+  }
+  uint64_t key =
+      hashBytes(signature.data(), signature.size() * sizeof(uint64_t));
+
+  std::vector<CachedPipelineLayout> &cached = pipelineLayouts.insert(key);
+  for (int i = 0; i < cached.size(); i++) {
+    if (cached[i].signature == signature) {
+      return cached[i].layout;
+    }
+  }
+
+  VkPipelineLayoutCreateInfo createInfo = {};
+  createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  createInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+  createInfo.pSetLayouts = setLayouts.data();
+  createInfo.pushConstantRangeCount =
+      static_cast<uint32_t>(pushConstantRanges.size());
+  createInfo.pPushConstantRanges = pushConstantRanges.data();
+
+  VkPipelineLayout layout;
+  if (vkCreatePipelineLayout(device, &createInfo, nullptr, &layout) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to create pipeline layout");
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created pipeline layout");
+  cached.push_back({signature, layout});
+  return layout;
+}
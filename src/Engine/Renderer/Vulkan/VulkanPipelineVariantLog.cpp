@@ -0,0 +1,168 @@
+#include "Engine/Renderer/Vulkan/VulkanPipelineVariantLog.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "document.h"
+#include "prettywriter.h"
+#include "stringbuffer.h"
+
+// Fields of a logged variant besides its path, in the order they are written
+static const char *const VARIANT_FIELDS[] = {
+    "topology",      "polygon_mode", "cull_mode",    "front_face",
+    "blend",         "depth_test",   "depth_write",  "depth_compare",
+    "color_format",  "depth_format", "samples"};
+static const int VARIANT_FIELD_COUNT = 11;
+
+// Reads one logged variant, false when a field is missing or mistyped
+static bool readVariant(const rapidjson::Value &entry, PipelineVariant &variant) {
+  if (!entry.IsObject() || !entry.HasMember("path") ||
+      !entry["path"].IsString()) {
+    return false;
+  }
+
+  uint32_t fields[VARIANT_FIELD_COUNT];
+  for (int i = 0; i < VARIANT_FIELD_COUNT; i++) {
+    rapidjson::Value::ConstMemberIterator member =
+        entry.FindMember(VARIANT_FIELDS[i]);
+    if (member == entry.MemberEnd() || !member->value.IsUint()) {
+      return false;
+    }
+    fields[i] = member->value.GetUint();
+  }
+
+  variant.path = entry["path"].GetString();
+  variant.state.topology = static_cast<VkPrimitiveTopology>(fields[0]);
+  variant.state.polygonMode = static_cast<VkPolygonMode>(fields[1]);
+  variant.state.cullMode = fields[2];
+  variant.state.frontFace = static_cast<VkFrontFace>(fields[3]);
+  variant.state.blendEnable = fields[4];
+  variant.state.depthTestEnable = fields[5];
+  variant.state.depthWriteEnable = fields[6];
+  variant.state.depthCompareOp = static_cast<VkCompareOp>(fields[7]);
+  variant.renderPassKey.colorFormat = static_cast<VkFormat>(fields[8]);
+  variant.renderPassKey.depthFormat = static_cast<VkFormat>(fields[9]);
+  variant.renderPassKey.samples = static_cast<VkSampleCountFlagBits>(fields[10]);
+  return true;
+}
+
+bool VulkanPipelineVariantLog::contains(const PipelineVariant &variant) {
+  for (int i = 0; i < variants.size(); i++) {
+    if (variants[i].path == variant.path &&
+        variants[i].state.getHash() == variant.state.getHash() &&
+        variants[i].renderPassKey == variant.renderPassKey) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void VulkanPipelineVariantLog::record(const PipelineVariant &variant) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!contains(variant)) {
+    variants.push_back(variant);
+  }
+}
+
+std::vector<PipelineVariant>
+VulkanPipelineVariantLog::getVariants(const std::string &path,
+                                      const RenderPassKey &renderPassKey) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::vector<PipelineVariant> matching;
+  for (int i = 0; i < variants.size(); i++) {
+    if (variants[i].path == path && variants[i].renderPassKey == renderPassKey) {
+      matching.push_back(variants[i]);
+    }
+  }
+  return matching;
+}
+
+bool VulkanPipelineVariantLog::load(const std::string &filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file) {
+    spdlog::debug("no pipeline variant log at {0}", filepath);
+    return false;
+  }
+  std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+
+  rapidjson::Document document;
+  document.Parse(buffer.data(), buffer.size());
+  if (document.HasParseError() || !document.IsObject() ||
+      !document.HasMember("variants") || !document["variants"].IsArray()) {
+    spdlog::error("invalid pipeline variant log {0}", filepath);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  const rapidjson::Value &list = document["variants"];
+  uint32_t skipped = 0;
+  for (rapidjson::SizeType i = 0; i < list.Size(); i++) {
+    PipelineVariant variant;
+    if (!readVariant(list[i], variant)) {
+      skipped++;
+      continue;
+    }
+
+    if (!contains(variant)) {
+      variants.push_back(variant);
+    }
+  }
+
+  if (skipped > 0) {
+    spdlog::warn("skipped {0} invalid entries of pipeline variant log {1}",
+                 skipped, filepath);
+  }
+  spdlog::info("loaded {0} pipeline variants from {1}", list.Size() - skipped,
+               filepath);
+  return true;
+}
+
+bool VulkanPipelineVariantLog::save(const std::string &filepath) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("variants");
+  writer.StartArray();
+  for (int i = 0; i < variants.size(); i++) {
+    const PipelineVariant &variant = variants[i];
+    uint32_t fields[VARIANT_FIELD_COUNT] = {
+        static_cast<uint32_t>(variant.state.topology),
+        static_cast<uint32_t>(variant.state.polygonMode),
+        static_cast<uint32_t>(variant.state.cullMode),
+        static_cast<uint32_t>(variant.state.frontFace),
+        variant.state.blendEnable,
+        variant.state.depthTestEnable,
+        variant.state.depthWriteEnable,
+        static_cast<uint32_t>(variant.state.depthCompareOp),
+        static_cast<uint32_t>(variant.renderPassKey.colorFormat),
+        static_cast<uint32_t>(variant.renderPassKey.depthFormat),
+        static_cast<uint32_t>(variant.renderPassKey.samples)};
+
+    // Escapes the path, unlike writing it into the file as is
+    writer.StartObject();
+    writer.Key("path");
+    writer.String(variant.path.c_str(),
+                  static_cast<rapidjson::SizeType>(variant.path.size()));
+    for (int j = 0; j < VARIANT_FIELD_COUNT; j++) {
+      writer.Key(VARIANT_FIELDS[j]);
+      writer.Uint(fields[j]);
+    }
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  std::ofstream file(filepath);
+  file << buffer.GetString() << "\n";
+
+  if (!file) {
+    spdlog::error("failed to write pipeline variant log {0}", filepath);
+    return false;
+  }
+  return true;
+}
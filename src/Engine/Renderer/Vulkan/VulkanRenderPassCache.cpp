@@ -0,0 +1,106 @@
+#include "Engine/Renderer/Vulkan/VulkanRenderPassCache.h"
+
+#include <vector>
+
+VulkanRenderPassCache::VulkanRenderPassCache(VkDevice device) {
+  this->device = device;
+}
+
+VulkanRenderPassCache::~VulkanRenderPassCache() {
+  renderPasses.forEach([this](uint64_t key, VkRenderPass &renderPass) {
+    vkDestroyRenderPass(device, renderPass, nullptr);
+  });
+}
+
+VkRenderPass
+VulkanRenderPassCache::getRenderPass(const RenderPassKey &renderPassKey) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  VkRenderPass *cached = renderPasses.find(renderPassKey.getHash());
+  if (cached != nullptr) {
+    return *cached;
+  }
+
+  VkRenderPass renderPass = createRenderPass(renderPassKey);
+  if (renderPass != VK_NULL_HANDLE) {
+    renderPasses.insert(renderPassKey.getHash()) = renderPass;
+  }
+  return renderPass;
+}
+
+VkRenderPass
+VulkanRenderPassCache::createRenderPass(const RenderPassKey &renderPassKey) {
+  std::vector<VkAttachmentDescription> attachments;
+
+  VkAttachmentDescription colorAttachment = {};
+  colorAttachment.format = renderPassKey.colorFormat;
+  colorAttachment.samples = renderPassKey.samples;
+  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  attachments.push_back(colorAttachment);
+
+  VkAttachmentReference colorAttachmentRef = {};
+  colorAttachmentRef.attachment = 0;
+  colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentReference depthAttachmentRef = {};
+  depthAttachmentRef.attachment = 1;
+  depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+  VkSubpassDescription subpass = {};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount = 1;
+  subpass.pColorAttachments = &colorAttachmentRef;
+
+  VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+  if (renderPassKey.depthFormat != VK_FORMAT_UNDEFINED) {
+    VkAttachmentDescription depthAttachment = {};
+    depthAttachment.format = renderPassKey.depthFormat;
+    depthAttachment.samples = renderPassKey.samples;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout =
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    attachments.push_back(depthAttachment);
+
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+  }
+
+  VkSubpassDependency dependency = {};
+  dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+  dependency.dstSubpass = 0;
+  dependency.srcStageMask = stages;
+  dependency.srcAccessMask = 0;
+  dependency.dstStageMask = stages;
+  dependency.dstAccessMask = access;
+
+  VkRenderPassCreateInfo renderPassInfo = {};
+  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+  renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+  renderPassInfo.pAttachments = attachments.data();
+  renderPassInfo.subpassCount = 1;
+  renderPassInfo.pSubpasses = &subpass;
+  renderPassInfo.dependencyCount = 1;
+  renderPassInfo.pDependencies = &dependency;
+
+  VkRenderPass renderPass;
+  if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to create render pass");
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created render pass");
+  return renderPass;
+}
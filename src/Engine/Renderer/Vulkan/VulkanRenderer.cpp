@@ -13,12 +13,20 @@ VulkanRenderer::~VulkanRenderer() {
                        nullptr);
     vkDestroySemaphore(device->getDevice(), renderFinishedSemaphores[i],
                        nullptr);
-    vkDestroyFence(device->getDevice(), inFlightFences[i], nullptr);
   }
 
   framebuffers.erase(framebuffers.begin(), framebuffers.end());
 
-  vkDestroyRenderPass(device->getDevice(), renderPass, nullptr);
+  delete asyncCompute;
+
+  // Retired swapchains must go before the surface they were created from
+  device->getDeletionQueue()->flush();
+
+  // Everything still cached holds device memory that must go before the
+  // allocator does
+  resourceManager->setCacheBudget(0);
+  resourceManager->trimCache();
+  resourceManager->flushRetired();
 
   delete swapchain;
   delete device;
@@ -61,10 +69,23 @@ void VulkanRenderer::init() {
   initSwapchain();
   volkLoadInstance(instance);
   device = new VulkanDevice(instance, pickPhysicalDevice());
+  // Block compressed textures and anisotropic filtering whenever available
+  deviceFeatures.textureCompressionBC = device->getFeatures().textureCompressionBC;
+  deviceFeatures.samplerAnisotropy = device->getFeatures().samplerAnisotropy;
+  // GPU culled meshes are drawn with one indirect call per mesh, each draw
+  // selecting its instance data through firstInstance
+  deviceFeatures.multiDrawIndirect = device->getFeatures().multiDrawIndirect;
+  deviceFeatures.drawIndirectFirstInstance =
+      device->getFeatures().drawIndirectFirstInstance;
   device->createLogicalDevice(deviceFeatures, deviceExtensions, nullptr);
   volkLoadDevice(device->getDevice());
   device->initAllocator();
-  swapchain->connect(device->getPhysicalDevice(), device->getDevice());
+  device->initTimeline();
+  device->initPipelineCache();
+  device->initResourceCaches();
+  asyncCompute = new VulkanAsyncCompute(device, MAX_FRAMES_IN_FLIGHT);
+  swapchain->connect(device->getPhysicalDevice(), device->getDevice(),
+                     device->getDeletionQueue());
   swapchain->create(params.x, params.y);
   initRenderPass();
   initFramebuffers();
@@ -72,69 +93,6 @@ void VulkanRenderer::init() {
   initSemaphores();
 }
 
-void VulkanRenderer::buildCommandbuffers() {
-  for (int i = 0; i < commandBuffers.size(); i++) {
-    VkCommandBufferBeginInfo beginInfo = {};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = 0;
-    beginInfo.pInheritanceInfo = nullptr;
-
-    if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-      spdlog::error("failed to begin vulkan command buffer");
-    } else {
-      spdlog::debug("began vulkan command buffer");
-    }
-
-    std::shared_ptr<VulkanPipelineResource> renderPipeline =
-        std::static_pointer_cast<VulkanPipelineResource>(
-            resourceManager->getResource(
-                "assets/shaders/test_vk_resource.json"));
-    std::shared_ptr<VulkanMeshResource> testMesh =
-        std::static_pointer_cast<VulkanMeshResource>(
-            resourceManager->getResource("assets/meshes/test_vk_mesh.json"));
-    VkPipeline pipeline = renderPipeline->getPipeline();
-
-    VkRenderPassBeginInfo renderPassInfo = {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = framebuffers[i].framebuffer;
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = {params.x, params.y};
-
-    VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-
-    vkCmdSetViewport(commandBuffers[i], 0, 1, &viewport);
-    vkCmdSetScissor(commandBuffers[i], 0, 1, &scissor);
-
-    vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      pipeline);
-
-    VkBuffer vertexBuffers[] = {testMesh->getVertexBuffer()};
-    VkDeviceSize offsets[] = {0};
-
-    vkCmdBindVertexBuffers(commandBuffers[i], 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffers[i], testMesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
-
-    vkCmdDrawIndexed(commandBuffers[i], static_cast<uint32_t>(testMesh->getIndexCount()), 1, 0, 0, 0);
-    vkCmdEndRenderPass(commandBuffers[i]);
-
-    if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-      spdlog::error("failed to record vulkan command buffer");
-    } else {
-      spdlog::debug("recorded vulkan command buffer");
-    }
-  }
-}
-
-void VulkanRenderer::beginFrame() {
-  buildCommandbuffers();
-  return;
-}
-
 void VulkanRenderer::drawFrame() {
 
 }
@@ -191,6 +149,12 @@ void VulkanRenderer::createInstance() {
     spdlog::error("failed to get required vulkan extension count from sdl2");
   }
 
+  if (checkInstanceExtensionSupport(
+          VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+    extensions.push_back(
+        VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  }
+
   size_t additional_count = extensions.size();
   extensions.resize(additional_count + extensionCount);
 
@@ -264,49 +228,14 @@ VulkanDevice *VulkanRenderer::getDevice() { return device; }
 
 VkRenderPass VulkanRenderer::getRenderPass() { return renderPass; }
 
+RenderPassKey VulkanRenderer::getRenderPassKey() { return renderPassKey; }
+
 void VulkanRenderer::initRenderPass() {
-  VkAttachmentDescription colorAttachment = {};
-  colorAttachment.format = swapchain->getImageFormat();
-  colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-  colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-  colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-  VkAttachmentReference colorAttachmentRef = {};
-  colorAttachmentRef.attachment = 0;
-  colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-  VkSubpassDescription subpass = {};
-  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-  subpass.colorAttachmentCount = 1;
-  subpass.pColorAttachments = &colorAttachmentRef;
-
-  VkSubpassDependency dependency = {};
-  dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-  dependency.dstSubpass = 0;
-  dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependency.srcAccessMask = 0;
-  dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-  VkRenderPassCreateInfo renderPassInfo = {};
-  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-  renderPassInfo.attachmentCount = 1;
-  renderPassInfo.pAttachments = &colorAttachment;
-  renderPassInfo.subpassCount = 1;
-  renderPassInfo.pSubpasses = &subpass;
-  renderPassInfo.dependencyCount = 1;
-  renderPassInfo.pDependencies = &dependency;
-
-  if (vkCreateRenderPass(device->getDevice(), &renderPassInfo, nullptr,
-                         &renderPass) != VK_SUCCESS) {
-    spdlog::error("failed to create render pass");
-  } else {
-    spdlog::debug("created render pass");
-  }
+  renderPassKey = RenderPassKey();
+  renderPassKey.colorFormat = swapchain->getImageFormat();
+  renderPassKey.samples = VK_SAMPLE_COUNT_1_BIT;
+
+  renderPass = device->getRenderPassCache()->getRenderPass(renderPassKey);
 }
 
 void VulkanRenderer::initFramebuffers() {
@@ -337,16 +266,22 @@ void VulkanRenderer::initFramebuffers() {
 }
 
 void VulkanRenderer::initCommandBuffers() {
+  // Only grows, buffers allocated for an earlier swapchain are reused as is
+  size_t allocated = commandBuffers.size();
+  if (framebuffers.size() <= allocated) {
+    return;
+  }
   commandBuffers.resize(framebuffers.size());
 
   VkCommandBufferAllocateInfo allocInfo = {};
   allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   allocInfo.commandPool = device->getCommandPool();
   allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandBufferCount = commandBuffers.size();
+  allocInfo.commandBufferCount =
+      static_cast<uint32_t>(commandBuffers.size() - allocated);
 
   if (vkAllocateCommandBuffers(device->getDevice(), &allocInfo,
-                               commandBuffers.data()) != VK_SUCCESS) {
+                               commandBuffers.data() + allocated) != VK_SUCCESS) {
     spdlog::error("failed to allocate command buffers");
   } else {
     spdlog::debug("allocated vulkan command buffers");
@@ -356,24 +291,17 @@ void VulkanRenderer::initCommandBuffers() {
 void VulkanRenderer::initSemaphores() {
   imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-  inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-  imagesInFlight.resize(swapchain->getSwapChainBuffers()->size(),
-                        VK_NULL_HANDLE);
+  framesInFlight.resize(MAX_FRAMES_IN_FLIGHT, 0);
+  imagesInFlight.resize(swapchain->getSwapChainBuffers()->size(), 0);
 
   VkSemaphoreCreateInfo semaphoreCreateInfo = {};
   semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-  VkFenceCreateInfo fenceCreateInfo = {};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
   for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
     if (vkCreateSemaphore(device->getDevice(), &semaphoreCreateInfo, nullptr,
                           &imageAvailableSemaphores[i]) != VK_SUCCESS ||
         vkCreateSemaphore(device->getDevice(), &semaphoreCreateInfo, nullptr,
-                          &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-        vkCreateFence(device->getDevice(), &fenceCreateInfo, nullptr,
-                      &inFlightFences[i])) {
+                          &renderFinishedSemaphores[i]) != VK_SUCCESS) {
       spdlog::error("failed to create vulkan semaphores");
     } else {
       spdlog::debug("created vulkan semaphores");
@@ -381,65 +309,118 @@ void VulkanRenderer::initSemaphores() {
   }
 }
 
-void VulkanRenderer::finishFrame() { vkDeviceWaitIdle(device->getDevice()); }
+void VulkanRenderer::updateResourceBudget() {
+  VkDeviceSize usage, budget;
+  device->getMemoryBudget(usage, budget);
 
-void VulkanRenderer::recreateSwapchain() {
-  vkDeviceWaitIdle(device->getDevice());
-  spdlog::debug("recreating swapchain");
+  // Over budget means the OS is reclaiming memory, drop everything cached
+  size_t cacheBudget =
+      usage < budget
+          ? static_cast<size_t>(budget * RESOURCE_CACHE_BUDGET_FRACTION)
+          : 0;
 
-  framebuffers.clear();
-  vkFreeCommandBuffers(device->getDevice(), device->getCommandPool(),
-                       static_cast<uint32_t>(commandBuffers.size()),
-                       commandBuffers.data());
-  commandBuffers.clear();
-  spdlog::debug("destroyed command buffers");
-  vkDestroyRenderPass(device->getDevice(), renderPass, nullptr);
-  spdlog::debug("destroyed render pass");
-
-  swapchain->cleanup();
-  spdlog::debug("destroyed swapchain");
-
-  // Doing this because sdl wasn't returning correct window size on ubuntu after
-  // resize with events in queue thats some bullshit
-  SDL_Event ev;
-  while (SDL_PollEvent(&ev)) {
-    spdlog::debug("flushing window event");
+  resourceManager->setCacheBudget(cacheBudget);
+  resourceManager->trimCache();
+}
+
+void VulkanRenderer::finishFrame() {
+  VulkanTimeline *timeline = device->getTimeline();
+  timeline->wait(timeline->getLastSubmittedValue());
+}
+
+void VulkanRenderer::requestResize() { resizePending = true; }
+
+void VulkanRenderer::retireFramebuffers() {
+  std::vector<VkFramebuffer> oldFramebuffers;
+  for (int i = 0; i < framebuffers.size(); i++) {
+    oldFramebuffers.push_back(framebuffers[i].framebuffer);
+    framebuffers[i].framebuffer = VK_NULL_HANDLE;
   }
+  framebuffers.clear();
 
+  VkDevice logicalDevice = device->getDevice();
+  device->getDeletionQueue()->defer([logicalDevice, oldFramebuffers]() {
+    for (int i = 0; i < oldFramebuffers.size(); i++) {
+      vkDestroyFramebuffer(logicalDevice, oldFramebuffers[i], nullptr);
+    }
+  });
+}
+
+bool VulkanRenderer::isMinimized() {
   int width, height;
   SDL_GetWindowSize(window, &width, &height);
+  return width == 0 || height == 0 ||
+         (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) != 0;
+}
 
-  params.x = width;
-  params.y = height;
+bool VulkanRenderer::recreateSwapchain() {
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
 
-  spdlog::debug("params set: {0} {1}", params.x, params.y);
+  // Nothing can be presented to a minimized window, the resize stays pending
+  // until the window is restored
+  if (width == 0 || height == 0) {
+    resizePending = true;
+    return false;
+  }
+  resizePending = false;
 
-  swapchain->initSurface(window);
-  swapchain->create(params.x, params.y);
+  // Frames in flight keep using the old framebuffers and image views, they
+  // are destroyed once those frames complete on the GPU
+  retireFramebuffers();
+  swapchain->create(width, height);
+
+  // The surface decides the extent, which can differ from the window size
+  params.x = swapchain->getExtent().width;
+  params.y = swapchain->getExtent().height;
+  initViewport();
+  spdlog::debug("recreated swapchain at {0} {1}", params.x, params.y);
+
+  // Same formats give back the same render pass, so every pipeline stays
+  // valid, a format change makes draws request their variants for the new key
+  RenderPassKey previousKey = renderPassKey;
   initRenderPass();
+  if (!(renderPassKey == previousKey)) {
+    spdlog::info("swapchain format changed, pipelines rebuild in the background");
+  }
+
   initFramebuffers();
   initCommandBuffers();
-  buildCommandbuffers();
+
+  // Command buffers are indexed by image, so the values of the old images
+  // still guard reuse of the same buffers for the new ones
+  imagesInFlight.resize(swapchain->getImageCount(), 0);
+  return true;
 }
 
-VulkanRenderFrame VulkanRenderer::prepareFrame() {
-  vkWaitForFences(device->getDevice(), 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+bool VulkanRenderer::prepareFrame(VulkanRenderFrame &renderFrame) {
+  VulkanTimeline *timeline = device->getTimeline();
+  timeline->wait(framesInFlight[currentFrame]);
+  device->getDeletionQueue()->collect();
+  // Refreshes the budget the resource cache is sized from
+  device->getMemoryStats()->update();
+  updateResourceBudget();
+
+  // Every resize since the last frame is handled by one recreation
+  if (resizePending && !recreateSwapchain()) {
+    return false;
+  }
 
   uint32_t imageIndex;
 
   VkResult result = vkAcquireNextImageKHR(device->getDevice(), swapchain->getSwapchain(), UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
-  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-    recreateSwapchain();
-  }
-
-  if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
-    vkWaitForFences(device->getDevice(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+  // Nothing was acquired and the semaphore stays unsignalled, try again on
+  // the new swapchain
+  while (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    if (!recreateSwapchain()) {
+      return false;
+    }
+    result = vkAcquireNextImageKHR(device->getDevice(), swapchain->getSwapchain(), UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
   }
 
-  imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+  timeline->wait(imagesInFlight[imageIndex]);
 
-  VulkanRenderFrame renderFrame;
   renderFrame.commandBuffer = commandBuffers[imageIndex];
   renderFrame.currentFrameIndex = currentFrame;
   renderFrame.currentImageIndex = imageIndex;
@@ -456,6 +437,7 @@ VulkanRenderFrame VulkanRenderer::prepareFrame() {
   renderPassInfo.pClearValues = &clearColor;
 
   renderFrame.renderPassBeginInfo = renderPassInfo;
+  renderFrame.renderPassKey = renderPassKey;
 
   VkCommandBufferBeginInfo beginInfo = {};
   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -466,20 +448,27 @@ VulkanRenderFrame VulkanRenderer::prepareFrame() {
 
   renderFrame.viewport = viewport;
   renderFrame.scissor = scissor;
+  renderFrame.extent = {params.x, params.y};
 
 
-  return renderFrame;
+  return true;
 }
 
 void VulkanRenderer::submitFrame(VulkanRenderFrame &renderFrame) {
   VkSubmitInfo submitInfo = {};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-  VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[renderFrame.currentFrameIndex] };
-  VkPipelineStageFlags waitStages[] = {
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+  uint32_t waitCount = renderFrame.waitSemaphoreCount;
+  VkSemaphore waitSemaphores[MAX_FRAME_WAIT_SEMAPHORES + 1];
+  VkPipelineStageFlags waitStages[MAX_FRAME_WAIT_SEMAPHORES + 1];
+  for (uint32_t i = 0; i < waitCount; i++) {
+    waitSemaphores[i] = renderFrame.waitSemaphores[i];
+    waitStages[i] = renderFrame.waitStages[i];
+  }
+  waitSemaphores[waitCount] = imageAvailableSemaphores[renderFrame.currentFrameIndex];
+  waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
-  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.waitSemaphoreCount = waitCount + 1;
   submitInfo.pWaitSemaphores = waitSemaphores;
   submitInfo.pWaitDstStageMask = waitStages;
 
@@ -490,12 +479,10 @@ void VulkanRenderer::submitFrame(VulkanRenderFrame &renderFrame) {
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores = signalSemaphores;
 
-  vkResetFences(device->getDevice(), 1, &inFlightFences[currentFrame]);
-
-  if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo,
-                    inFlightFences[currentFrame]) != VK_SUCCESS) {
-    spdlog::error("error submitting vulkan queue");
-  }
+  uint64_t submitValue = device->getTimeline()->submit(device->getGraphicsQueue(), submitInfo);
+  framesInFlight[currentFrame] = submitValue;
+  imagesInFlight[renderFrame.currentImageIndex] = submitValue;
+  device->getDeletionQueue()->endFrame(submitValue);
 
   VkPresentInfoKHR presentInfo = {};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -507,16 +494,21 @@ void VulkanRenderer::submitFrame(VulkanRenderFrame &renderFrame) {
   presentInfo.pSwapchains = swapchains;
   presentInfo.pImageIndices = &(renderFrame.currentImageIndex);
 
-  VkResult result = vkQueuePresentKHR(device->getGraphicsQueue(), &presentInfo);
+  VkResult result = device->getTimeline()->present(device->getGraphicsQueue(), presentInfo);
+
+  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
+  // Recreated at the start of the next frame, together with any resize
+  // events that arrive in between
   if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-    recreateSwapchain();
-    return;
+    resizePending = true;
   } else if (result != VK_SUCCESS) {
     spdlog::error("error during vulkan presentation");
   }
+}
 
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+VulkanAsyncCompute *VulkanRenderer::getAsyncCompute() {
+  return asyncCompute;
 }
 
 int VulkanRenderer::getFrameCount() {
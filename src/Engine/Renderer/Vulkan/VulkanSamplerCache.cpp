@@ -0,0 +1,77 @@
+#include "Engine/Renderer/Vulkan/VulkanSamplerCache.h"
+
+#include <cstring>
+
+// Field by field, the struct itself has padding and a pNext pointer
+VulkanSamplerCache::SamplerKey
+VulkanSamplerCache::getSamplerKey(const VkSamplerCreateInfo &createInfo) {
+  SamplerKey fields = {createInfo.flags,
+                       static_cast<uint32_t>(createInfo.magFilter),
+                       static_cast<uint32_t>(createInfo.minFilter),
+                       static_cast<uint32_t>(createInfo.mipmapMode),
+                       static_cast<uint32_t>(createInfo.addressModeU),
+                       static_cast<uint32_t>(createInfo.addressModeV),
+                       static_cast<uint32_t>(createInfo.addressModeW),
+                       0,
+                       createInfo.anisotropyEnable,
+                       0,
+                       createInfo.compareEnable,
+                       static_cast<uint32_t>(createInfo.compareOp),
+                       0,
+                       0,
+                       static_cast<uint32_t>(createInfo.borderColor),
+                       createInfo.unnormalizedCoordinates};
+  std::memcpy(&fields[7], &createInfo.mipLodBias, sizeof(float));
+  std::memcpy(&fields[9], &createInfo.maxAnisotropy, sizeof(float));
+  std::memcpy(&fields[12], &createInfo.minLod, sizeof(float));
+  std::memcpy(&fields[13], &createInfo.maxLod, sizeof(float));
+  return fields;
+}
+
+VulkanSamplerCache::VulkanSamplerCache(VkDevice device, uint32_t maxSamplers) {
+  this->device = device;
+  this->maxSamplers = maxSamplers;
+}
+
+VulkanSamplerCache::~VulkanSamplerCache() {
+  samplers.forEach([this](uint64_t hash, std::vector<CachedSampler> &cached) {
+    for (int i = 0; i < cached.size(); i++) {
+      vkDestroySampler(device, cached[i].sampler, nullptr);
+    }
+  });
+}
+
+VkSampler VulkanSamplerCache::getSampler(const VkSamplerCreateInfo &createInfo) {
+  SamplerKey key = getSamplerKey(createInfo);
+  uint64_t hash = hashBytes(key.data(), sizeof(key));
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::vector<CachedSampler> &cached = samplers.insert(hash);
+  for (int i = 0; i < cached.size(); i++) {
+    if (cached[i].key == key) {
+      return cached[i].sampler;
+    }
+  }
+
+  if (samplerCount >= maxSamplers) {
+    spdlog::error("sampler limit of {0} reached", maxSamplers);
+    return VK_NULL_HANDLE;
+  }
+
+  VkSampler sampler;
+  if (vkCreateSampler(device, &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+    spdlog::error("failed to create vulkan sampler");
+    return VK_NULL_HANDLE;
+  }
+
+  spdlog::debug("created vulkan sampler {0}", samplerCount);
+  cached.push_back({key, sampler});
+  samplerCount++;
+  return sampler;
+}
+
+size_t VulkanSamplerCache::getSamplerCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return samplerCount;
+}
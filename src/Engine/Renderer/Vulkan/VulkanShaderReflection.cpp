@@ -0,0 +1,467 @@
+#include "Engine/Renderer/Vulkan/VulkanShaderReflection.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+// Opcodes, decorations, storage classes and execution models from the SPIR-V
+// specification that reflection needs
+enum SPIRV_OP : uint32_t {
+  OP_ENTRY_POINT = 15,
+  OP_TYPE_INT = 21,
+  OP_TYPE_FLOAT = 22,
+  OP_TYPE_VECTOR = 23,
+  OP_TYPE_MATRIX = 24,
+  OP_TYPE_IMAGE = 25,
+  OP_TYPE_SAMPLER = 26,
+  OP_TYPE_SAMPLED_IMAGE = 27,
+  OP_TYPE_ARRAY = 28,
+  OP_TYPE_RUNTIME_ARRAY = 29,
+  OP_TYPE_STRUCT = 30,
+  OP_TYPE_POINTER = 32,
+  OP_CONSTANT = 43,
+  OP_VARIABLE = 59,
+  OP_DECORATE = 71,
+  OP_MEMBER_DECORATE = 72
+};
+
+enum SPIRV_DECORATION : uint32_t {
+  DECORATION_BLOCK = 2,
+  DECORATION_BUFFER_BLOCK = 3,
+  DECORATION_ARRAY_STRIDE = 6,
+  DECORATION_MATRIX_STRIDE = 7,
+  DECORATION_BUILT_IN = 11,
+  DECORATION_LOCATION = 30,
+  DECORATION_BINDING = 33,
+  DECORATION_DESCRIPTOR_SET = 34,
+  DECORATION_OFFSET = 35
+};
+
+enum SPIRV_STORAGE_CLASS : uint32_t {
+  STORAGE_UNIFORM_CONSTANT = 0,
+  STORAGE_INPUT = 1,
+  STORAGE_UNIFORM = 2,
+  STORAGE_PUSH_CONSTANT = 9,
+  STORAGE_STORAGE_BUFFER = 12
+};
+
+static const uint32_t IMAGE_DIM_BUFFER = 5;
+static const uint32_t IMAGE_DIM_SUBPASS_DATA = 6;
+static const uint32_t IMAGE_SAMPLED_STORAGE = 2;
+
+struct SpirvMember {
+  uint32_t offset = 0;
+  uint32_t matrixStride = 0;
+};
+
+// Everything known about one result id, which fields are meaningful depends
+// on the opcode that defined it
+struct SpirvId {
+  uint32_t opcode = 0;
+  uint32_t typeId = 0;
+  uint32_t storageClass = 0;
+  // Component count, bit width, array length id or constant value
+  uint32_t count = 0;
+  bool isSigned = false;
+
+  uint32_t imageDim = 0;
+  uint32_t imageSampled = 0;
+
+  std::vector<uint32_t> members;
+  std::vector<SpirvMember> memberLayout;
+
+  uint32_t set = 0;
+  uint32_t binding = UINT32_MAX;
+  uint32_t location = UINT32_MAX;
+  uint32_t arrayStride = 0;
+  bool block = false;
+  bool bufferBlock = false;
+  bool builtIn = false;
+};
+
+static VkShaderStageFlags getStage(uint32_t executionModel) {
+  switch (executionModel) {
+  case 0:
+    return VK_SHADER_STAGE_VERTEX_BIT;
+  case 1:
+    return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+  case 2:
+    return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+  case 3:
+    return VK_SHADER_STAGE_GEOMETRY_BIT;
+  case 4:
+    return VK_SHADER_STAGE_FRAGMENT_BIT;
+  case 5:
+    return VK_SHADER_STAGE_COMPUTE_BIT;
+  default:
+    return 0;
+  }
+}
+
+static uint32_t getTypeSize(const std::vector<SpirvId> &ids, uint32_t typeId) {
+  if (typeId >= ids.size()) {
+    return 0;
+  }
+
+  const SpirvId &type = ids[typeId];
+  switch (type.opcode) {
+  case OP_TYPE_INT:
+  case OP_TYPE_FLOAT:
+    return type.count / 8;
+  case OP_TYPE_VECTOR:
+  case OP_TYPE_MATRIX:
+    return type.count * getTypeSize(ids, type.typeId);
+  case OP_TYPE_ARRAY: {
+    uint32_t length = type.count < ids.size() ? ids[type.count].count : 0;
+    uint32_t stride = type.arrayStride > 0 ? type.arrayStride
+                                           : getTypeSize(ids, type.typeId);
+    return length * stride;
+  }
+  case OP_TYPE_STRUCT: {
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < type.members.size(); i++) {
+      if (type.members[i] >= ids.size()) {
+        continue;
+      }
+      const SpirvId &member = ids[type.members[i]];
+      const SpirvMember &layout = type.memberLayout[i];
+      uint32_t memberSize = member.opcode == OP_TYPE_MATRIX &&
+                                    layout.matrixStride > 0
+                                ? member.count * layout.matrixStride
+                                : getTypeSize(ids, type.members[i]);
+      size = std::max(size, layout.offset + memberSize);
+    }
+    return size;
+  }
+  default:
+    return 0;
+  }
+}
+
+static VkFormat getInputFormat(const std::vector<SpirvId> &ids,
+                               uint32_t typeId) {
+  if (typeId >= ids.size()) {
+    return VK_FORMAT_UNDEFINED;
+  }
+
+  const SpirvId &type = ids[typeId];
+  uint32_t components = 1;
+  const SpirvId *scalar = &type;
+  if (type.opcode == OP_TYPE_VECTOR && type.typeId < ids.size()) {
+    components = type.count;
+    scalar = &ids[type.typeId];
+  }
+
+  if (scalar->count != 32 || components < 1 || components > 4) {
+    return VK_FORMAT_UNDEFINED;
+  }
+
+  const VkFormat floatFormats[] = {
+      VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+      VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+  const VkFormat intFormats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                                 VK_FORMAT_R32G32B32_SINT,
+                                 VK_FORMAT_R32G32B32A32_SINT};
+  const VkFormat uintFormats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                                  VK_FORMAT_R32G32B32_UINT,
+                                  VK_FORMAT_R32G32B32A32_UINT};
+
+  if (scalar->opcode == OP_TYPE_FLOAT) {
+    return floatFormats[components - 1];
+  }
+  if (scalar->opcode == OP_TYPE_INT) {
+    return scalar->isSigned ? intFormats[components - 1]
+                            : uintFormats[components - 1];
+  }
+  return VK_FORMAT_UNDEFINED;
+}
+
+static bool getDescriptorType(const std::vector<SpirvId> &ids,
+                              const SpirvId &variable, uint32_t typeId,
+                              VkDescriptorType &descriptorType) {
+  const SpirvId &type = ids[typeId];
+
+  switch (variable.storageClass) {
+  case STORAGE_UNIFORM:
+    descriptorType = type.bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                      : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    return true;
+  case STORAGE_STORAGE_BUFFER:
+    descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    return true;
+  case STORAGE_UNIFORM_CONSTANT:
+    if (type.opcode == OP_TYPE_SAMPLED_IMAGE) {
+      descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      return true;
+    }
+    if (type.opcode == OP_TYPE_SAMPLER) {
+      descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+      return true;
+    }
+    if (type.opcode == OP_TYPE_IMAGE) {
+      bool storage = type.imageSampled == IMAGE_SAMPLED_STORAGE;
+      if (type.imageDim == IMAGE_DIM_BUFFER) {
+        descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                                 : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+      } else if (type.imageDim == IMAGE_DIM_SUBPASS_DATA) {
+        descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+      } else {
+        descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                 : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+      }
+      return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+void ShaderReflection::merge(const ShaderReflection &other) {
+  for (int i = 0; i < other.bindings.size(); i++) {
+    const ShaderBinding &binding = other.bindings[i];
+    auto existing =
+        std::find_if(bindings.begin(), bindings.end(), [&](const auto &b) {
+          return b.set == binding.set && b.binding == binding.binding;
+        });
+
+    if (existing == bindings.end()) {
+      bindings.push_back(binding);
+      continue;
+    }
+
+    if (existing->descriptorType != binding.descriptorType) {
+      spdlog::error("stages disagree on the type of set {0} binding {1}",
+                    binding.set, binding.binding);
+    }
+    existing->stageFlags |= binding.stageFlags;
+    existing->descriptorCount =
+        std::max(existing->descriptorCount, binding.descriptorCount);
+  }
+
+  pushConstantSize = std::max(pushConstantSize, other.pushConstantSize);
+  pushConstantStages |= other.pushConstantStages;
+
+  if (other.stageFlags & VK_SHADER_STAGE_VERTEX_BIT) {
+    inputs.insert(inputs.end(), other.inputs.begin(), other.inputs.end());
+  }
+  stageFlags |= other.stageFlags;
+}
+
+uint32_t ShaderReflection::getSetCount() const {
+  uint32_t count = 0;
+  for (int i = 0; i < bindings.size(); i++) {
+    count = std::max(count, bindings[i].set + 1);
+  }
+  return count;
+}
+
+bool reflectShader(const std::vector<char> &code,
+                   ShaderReflection &reflection) {
+  if (code.size() < 5 * sizeof(uint32_t) || code.size() % 4 != 0) {
+    spdlog::error("shader code is not valid SPIR-V");
+    return false;
+  }
+
+  std::vector<uint32_t> words(code.size() / 4);
+  memcpy(words.data(), code.data(), code.size());
+
+  if (words[0] != SPIRV_MAGIC) {
+    spdlog::error("shader code is not valid SPIR-V");
+    return false;
+  }
+
+  // Ids are bounded by the header, so every id indexes a flat array
+  std::vector<SpirvId> ids(words[3]);
+  std::vector<uint32_t> variables;
+
+  for (size_t i = 5; i < words.size();) {
+    uint32_t opcode = words[i] & 0xFFFF;
+    uint32_t wordCount = words[i] >> 16;
+    if (wordCount == 0 || i + wordCount > words.size()) {
+      spdlog::error("truncated SPIR-V instruction");
+      return false;
+    }
+    const uint32_t *op = &words[i];
+    i += wordCount;
+
+    // Result ids sit in operand 1 for types and operand 2 for values
+    auto id = [&](uint32_t operand) -> SpirvId * {
+      if (operand >= wordCount || op[operand] >= ids.size()) {
+        return nullptr;
+      }
+      return &ids[op[operand]];
+    };
+
+    switch (opcode) {
+    case OP_ENTRY_POINT:
+      reflection.stageFlags |= getStage(op[1]);
+      break;
+    case OP_TYPE_INT:
+    case OP_TYPE_FLOAT:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->count = op[2];
+        type->isSigned = opcode == OP_TYPE_INT && wordCount > 3 && op[3] == 1;
+      }
+      break;
+    case OP_TYPE_VECTOR:
+    case OP_TYPE_MATRIX:
+    case OP_TYPE_ARRAY:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->typeId = op[2];
+        type->count = op[3];
+      }
+      break;
+    case OP_TYPE_RUNTIME_ARRAY:
+    case OP_TYPE_SAMPLED_IMAGE:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->typeId = op[2];
+      }
+      break;
+    case OP_TYPE_IMAGE:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->imageDim = op[3];
+        type->imageSampled = op[7];
+      }
+      break;
+    case OP_TYPE_SAMPLER:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+      }
+      break;
+    case OP_TYPE_STRUCT:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->members.assign(op + 2, op + wordCount);
+        type->memberLayout.resize(std::max(type->memberLayout.size(),
+                                           type->members.size()));
+      }
+      break;
+    case OP_TYPE_POINTER:
+      if (SpirvId *type = id(1)) {
+        type->opcode = opcode;
+        type->storageClass = op[2];
+        type->typeId = op[3];
+      }
+      break;
+    case OP_CONSTANT:
+      if (SpirvId *constant = id(2)) {
+        constant->opcode = opcode;
+        constant->typeId = op[1];
+        constant->count = op[3];
+      }
+      break;
+    case OP_VARIABLE:
+      if (SpirvId *variable = id(2)) {
+        variable->opcode = opcode;
+        variable->typeId = op[1];
+        variable->storageClass = op[3];
+        variables.push_back(op[2]);
+      }
+      break;
+    case OP_DECORATE:
+      if (SpirvId *target = id(1)) {
+        uint32_t value = wordCount > 3 ? op[3] : 0;
+        switch (op[2]) {
+        case DECORATION_BLOCK:
+          target->block = true;
+          break;
+        case DECORATION_BUFFER_BLOCK:
+          target->bufferBlock = true;
+          break;
+        case DECORATION_ARRAY_STRIDE:
+          target->arrayStride = value;
+          break;
+        case DECORATION_BUILT_IN:
+          target->builtIn = true;
+          break;
+        case DECORATION_LOCATION:
+          target->location = value;
+          break;
+        case DECORATION_BINDING:
+          target->binding = value;
+          break;
+        case DECORATION_DESCRIPTOR_SET:
+          target->set = value;
+          break;
+        }
+      }
+      break;
+    case OP_MEMBER_DECORATE:
+      if (SpirvId *target = id(1)) {
+        uint32_t member = op[2];
+        if (target->memberLayout.size() <= member) {
+          target->memberLayout.resize(member + 1);
+        }
+        if (op[3] == DECORATION_OFFSET) {
+          target->memberLayout[member].offset = op[4];
+        } else if (op[3] == DECORATION_MATRIX_STRIDE) {
+          target->memberLayout[member].matrixStride = op[4];
+        }
+      }
+      break;
+    }
+  }
+
+  for (int i = 0; i < variables.size(); i++) {
+    const SpirvId &variable = ids[variables[i]];
+    if (variable.typeId >= ids.size() ||
+        ids[variable.typeId].typeId >= ids.size()) {
+      continue;
+    }
+    uint32_t typeId = ids[variable.typeId].typeId;
+
+    if (variable.storageClass == STORAGE_PUSH_CONSTANT) {
+      reflection.pushConstantSize =
+          std::max(reflection.pushConstantSize, getTypeSize(ids, typeId));
+      reflection.pushConstantStages |= reflection.stageFlags;
+      continue;
+    }
+
+    if (variable.storageClass == STORAGE_INPUT) {
+      if (!variable.builtIn && variable.location != UINT32_MAX &&
+          (reflection.stageFlags & VK_SHADER_STAGE_VERTEX_BIT)) {
+        ShaderInput input;
+        input.location = variable.location;
+        input.format = getInputFormat(ids, typeId);
+        reflection.inputs.push_back(input);
+      }
+      continue;
+    }
+
+    if (variable.binding == UINT32_MAX) {
+      continue;
+    }
+
+    uint32_t descriptorCount = 1;
+    if (ids[typeId].opcode == OP_TYPE_ARRAY) {
+      uint32_t lengthId = ids[typeId].count;
+      descriptorCount = lengthId < ids.size() ? ids[lengthId].count : 1;
+      typeId = ids[typeId].typeId;
+    } else if (ids[typeId].opcode == OP_TYPE_RUNTIME_ARRAY) {
+      typeId = ids[typeId].typeId;
+    }
+    if (typeId >= ids.size()) {
+      continue;
+    }
+
+    ShaderBinding binding;
+    binding.set = variable.set;
+    binding.binding = variable.binding;
+    binding.descriptorCount = descriptorCount;
+    binding.stageFlags = reflection.stageFlags;
+
+    if (getDescriptorType(ids, variable, typeId, binding.descriptorType)) {
+      reflection.bindings.push_back(binding);
+    }
+  }
+
+  std::sort(reflection.inputs.begin(), reflection.inputs.end(),
+            [](const auto &a, const auto &b) { return a.location < b.location; });
+  return true;
+}
@@ -0,0 +1,263 @@
+#include "Engine/Renderer/Vulkan/VulkanTextureContainer.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K',  'T',  'X', ' ',  '2',
+                                            '0',  0xBB, '\r', '\n', 0x1A, '\n'};
+static const size_t KTX2_HEADER_SIZE = 80;
+static const size_t KTX2_LEVEL_SIZE = 24;
+
+static const uint32_t DDS_MAGIC = 0x20534444;
+static const size_t DDS_HEADER_SIZE = 128;
+static const size_t DDS_DX10_HEADER_SIZE = 20;
+static const uint32_t DDS_PIXEL_FORMAT_FOURCC = 0x4;
+static const uint32_t DDS_PIXEL_FORMAT_RGB = 0x40;
+static const uint32_t DDS_CAPS2_CUBEMAP = 0x200;
+static const uint32_t DDS_CAPS2_VOLUME = 0x200000;
+
+static uint32_t makeFourCC(const char *code) {
+  return static_cast<uint32_t>(code[0]) |
+         (static_cast<uint32_t>(code[1]) << 8) |
+         (static_cast<uint32_t>(code[2]) << 16) |
+         (static_cast<uint32_t>(code[3]) << 24);
+}
+
+static uint32_t readU32(const std::vector<char> &data, size_t offset) {
+  uint32_t value;
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+static uint64_t readU64(const std::vector<char> &data, size_t offset) {
+  uint64_t value;
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+static bool isSupportedFormat(VkFormat format) {
+  switch (format) {
+  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+  case VK_FORMAT_BC3_UNORM_BLOCK:
+  case VK_FORMAT_BC3_SRGB_BLOCK:
+  case VK_FORMAT_BC5_UNORM_BLOCK:
+  case VK_FORMAT_BC5_SNORM_BLOCK:
+  case VK_FORMAT_BC7_UNORM_BLOCK:
+  case VK_FORMAT_BC7_SRGB_BLOCK:
+  case VK_FORMAT_R8G8B8A8_UNORM:
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static VkFormat getDxgiFormat(uint32_t dxgiFormat) {
+  switch (dxgiFormat) {
+  case 28:
+    return VK_FORMAT_R8G8B8A8_UNORM;
+  case 29:
+    return VK_FORMAT_R8G8B8A8_SRGB;
+  case 71:
+    return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+  case 72:
+    return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+  case 77:
+    return VK_FORMAT_BC3_UNORM_BLOCK;
+  case 78:
+    return VK_FORMAT_BC3_SRGB_BLOCK;
+  case 83:
+    return VK_FORMAT_BC5_UNORM_BLOCK;
+  case 84:
+    return VK_FORMAT_BC5_SNORM_BLOCK;
+  case 98:
+    return VK_FORMAT_BC7_UNORM_BLOCK;
+  case 99:
+    return VK_FORMAT_BC7_SRGB_BLOCK;
+  default:
+    return VK_FORMAT_UNDEFINED;
+  }
+}
+
+// Mips stored back to back from the base level, as DDS lays them out
+static bool addPackedMips(const std::vector<char> &data, size_t offset,
+                          uint32_t mipCount, TextureData &texture) {
+  uint32_t width = texture.width;
+  uint32_t height = texture.height;
+  for (uint32_t level = 0; level < mipCount; level++) {
+    TextureMip mip;
+    mip.offset = offset;
+    mip.size = getMipSize(texture.format, width, height);
+    mip.width = width;
+    mip.height = height;
+    if (mip.offset > data.size() || mip.size > data.size() - mip.offset) {
+      spdlog::error("texture mip {0} runs past the end of the file", level);
+      return false;
+    }
+    texture.mips.push_back(mip);
+
+    offset += mip.size;
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+  }
+  return true;
+}
+
+static bool parseKtx2(const std::vector<char> &data, TextureData &texture) {
+  if (data.size() < KTX2_HEADER_SIZE) {
+    spdlog::error("truncated ktx2 header");
+    return false;
+  }
+
+  texture.format = static_cast<VkFormat>(readU32(data, 12));
+  texture.width = readU32(data, 20);
+  texture.height = readU32(data, 24);
+  uint32_t depth = readU32(data, 28);
+  uint32_t layerCount = readU32(data, 32);
+  uint32_t faceCount = readU32(data, 36);
+  uint32_t levelCount = std::max(1u, readU32(data, 40));
+  uint32_t supercompression = readU32(data, 44);
+
+  if (depth > 1 || layerCount > 1 || faceCount > 1) {
+    spdlog::error("only 2d ktx2 textures are supported");
+    return false;
+  }
+  if (supercompression != 0) {
+    spdlog::error("supercompressed ktx2 textures are not supported");
+    return false;
+  }
+  if (KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_SIZE > data.size()) {
+    spdlog::error("truncated ktx2 level index");
+    return false;
+  }
+
+  uint32_t width = texture.width;
+  uint32_t height = texture.height;
+  for (uint32_t level = 0; level < levelCount; level++) {
+    size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_SIZE;
+
+    TextureMip mip;
+    mip.offset = static_cast<size_t>(readU64(data, entry));
+    mip.size = static_cast<size_t>(readU64(data, entry + 8));
+    mip.width = width;
+    mip.height = height;
+    if (mip.offset > data.size() || mip.size > data.size() - mip.offset ||
+        mip.size < getMipSize(texture.format, width, height)) {
+      spdlog::error("invalid ktx2 mip level {0}", level);
+      return false;
+    }
+    texture.mips.push_back(mip);
+
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+  }
+  return true;
+}
+
+static bool parseDds(const std::vector<char> &data, TextureData &texture) {
+  if (data.size() < DDS_HEADER_SIZE) {
+    spdlog::error("truncated dds header");
+    return false;
+  }
+
+  texture.height = readU32(data, 12);
+  texture.width = readU32(data, 16);
+  uint32_t depth = readU32(data, 24);
+  uint32_t mipCount = std::max(1u, readU32(data, 28));
+  uint32_t pixelFlags = readU32(data, 80);
+  uint32_t fourCC = readU32(data, 84);
+  uint32_t bitCount = readU32(data, 88);
+  uint32_t redMask = readU32(data, 92);
+  uint32_t caps2 = readU32(data, 112);
+
+  if (depth > 1 || (caps2 & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME))) {
+    spdlog::error("only 2d dds textures are supported");
+    return false;
+  }
+
+  size_t offset = DDS_HEADER_SIZE;
+  if (pixelFlags & DDS_PIXEL_FORMAT_FOURCC) {
+    if (fourCC == makeFourCC("DX10")) {
+      if (data.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE) {
+        spdlog::error("truncated dds dx10 header");
+        return false;
+      }
+      if (readU32(data, DDS_HEADER_SIZE + 12) > 1) {
+        spdlog::error("dds texture arrays are not supported");
+        return false;
+      }
+      texture.format = getDxgiFormat(readU32(data, DDS_HEADER_SIZE));
+      offset += DDS_DX10_HEADER_SIZE;
+    } else if (fourCC == makeFourCC("DXT1")) {
+      texture.format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    } else if (fourCC == makeFourCC("DXT5")) {
+      texture.format = VK_FORMAT_BC3_UNORM_BLOCK;
+    } else if (fourCC == makeFourCC("ATI2") || fourCC == makeFourCC("BC5U")) {
+      texture.format = VK_FORMAT_BC5_UNORM_BLOCK;
+    }
+  } else if ((pixelFlags & DDS_PIXEL_FORMAT_RGB) && bitCount == 32 &&
+             redMask == 0x000000FF) {
+    texture.format = VK_FORMAT_R8G8B8A8_UNORM;
+  }
+
+  if (texture.format == VK_FORMAT_UNDEFINED) {
+    spdlog::error("unsupported dds pixel format");
+    return false;
+  }
+  return addPackedMips(data, offset, mipCount, texture);
+}
+
+bool TextureData::isCompressed() const {
+  return format != VK_FORMAT_R8G8B8A8_UNORM &&
+         format != VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+bool parseTextureContainer(const std::vector<char> &data,
+                           TextureData &texture) {
+  texture = TextureData();
+
+  bool parsed = false;
+  if (data.size() >= sizeof(KTX2_IDENTIFIER) &&
+      memcmp(data.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+    parsed = parseKtx2(data, texture);
+  } else if (data.size() >= sizeof(uint32_t) && readU32(data, 0) == DDS_MAGIC) {
+    parsed = parseDds(data, texture);
+  } else {
+    spdlog::error("unknown texture container");
+    return false;
+  }
+
+  if (!parsed) {
+    return false;
+  }
+  if (!isSupportedFormat(texture.format) || texture.width == 0 ||
+      texture.height == 0) {
+    spdlog::error("unsupported texture format {0}", texture.format);
+    return false;
+  }
+  return true;
+}
+
+uint32_t getFullMipCount(uint32_t width, uint32_t height) {
+  uint32_t mipCount = 1;
+  while (width > 1 || height > 1) {
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+    mipCount++;
+  }
+  return mipCount;
+}
+
+size_t getMipSize(VkFormat format, uint32_t width, uint32_t height) {
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_UNORM:
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    return static_cast<size_t>(width) * height * 4;
+  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+  default:
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+  }
+}
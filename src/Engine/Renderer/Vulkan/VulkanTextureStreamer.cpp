@@ -0,0 +1,261 @@
+#include "Engine/Renderer/Vulkan/VulkanTextureStreamer.h"
+
+#include <algorithm>
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanTextureResource.h"
+#include "Engine/Resources/ResourceManager.h"
+
+static const size_t MIP_COPY_ALIGNMENT = 16;
+
+VulkanTextureStreamer::VulkanTextureStreamer(VulkanDevice *device,
+                                             VkDeviceSize budget) {
+  this->device = device;
+  this->budget = budget;
+}
+
+VulkanTextureStreamer::~VulkanTextureStreamer() {
+  JobSystem::getInstance()->wait(&stagingJobs);
+  for (int i = 0; i < textures.size(); i++) {
+    delete textures[i].targetImage;
+  }
+}
+
+void VulkanTextureStreamer::registerTexture(VulkanTextureResource *texture) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  StreamedTexture entry;
+  entry.texture = texture;
+  entry.wantedMip = texture->getResidentMip();
+  textures.push_back(entry);
+}
+
+void VulkanTextureStreamer::unregisterTexture(VulkanTextureResource *texture) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  for (int i = 0; i < textures.size(); i++) {
+    if (textures[i].texture == texture) {
+      // A staging job still running keeps its own reference to the data
+      delete textures[i].targetImage;
+      textures[i] = textures.back();
+      textures.pop_back();
+      return;
+    }
+  }
+}
+
+void VulkanTextureStreamer::setBudget(VkDeviceSize budget) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->budget = budget;
+}
+
+void VulkanTextureStreamer::stageMips(StreamedTexture &entry) {
+  std::shared_ptr<StagedMips> staged(new StagedMips());
+  entry.staged = staged;
+
+  VulkanDevice *device = this->device;
+  std::string path = entry.texture->getSourcePath();
+  TextureData layout = entry.texture->getLayout();
+  uint32_t firstMip = entry.targetMip;
+  uint32_t lastMip = entry.texture->getResidentMip();
+
+  JobSystem::getInstance()->run([device, staged, path, layout, firstMip, lastMip]() {
+    std::vector<char> data;
+    TextureData texture;
+    if (!ResourceManager::getInstance()->readFile(path, data) ||
+        !parseTextureContainer(data, texture) ||
+        texture.mips.size() != layout.mips.size()) {
+      spdlog::error("failed to stream mips of {0}", path);
+      staged->failed = true;
+      staged->ready = true;
+      return;
+    }
+
+    size_t stagingSize = 0;
+    for (uint32_t level = firstMip; level < lastMip; level++) {
+      const TextureMip &mip = texture.mips[level];
+
+      VkBufferImageCopy region = {};
+      region.bufferOffset = stagingSize;
+      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel = level - firstMip;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount = 1;
+      region.imageOffset = {0, 0, 0};
+      region.imageExtent = {mip.width, mip.height, 1};
+      staged->regions.push_back(region);
+
+      stagingSize += (mip.size + MIP_COPY_ALIGNMENT - 1) & ~(MIP_COPY_ALIGNMENT - 1);
+    }
+
+    staged->buffer = new VulkanBuffer(device, stagingSize,
+                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                      VMA_MEMORY_USAGE_CPU_ONLY,
+                                      VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                                      MEMORY_POOL_STAGING);
+    for (int i = 0; i < staged->regions.size(); i++) {
+      const TextureMip &mip = texture.mips[firstMip + i];
+      staged->buffer->update(data.data() + mip.offset, mip.size,
+                             static_cast<size_t>(staged->regions[i].bufferOffset));
+    }
+    staged->ready = true;
+  }, &stagingJobs);
+}
+
+void VulkanTextureStreamer::startTransfer(StreamedTexture &entry) {
+  VulkanTextureResource *texture = entry.texture;
+  const TextureData &layout = texture->getLayout();
+  VulkanImage *source = texture->getVulkanImage();
+
+  uint32_t residentMip = texture->getResidentMip();
+  uint32_t mipCount = texture->getMipLevels();
+  const TextureMip &base = layout.mips[entry.targetMip];
+
+  entry.targetImage = new VulkanImage(
+      device, base.width, base.height, layout.format,
+      mipCount - entry.targetMip,
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+          VK_IMAGE_USAGE_SAMPLED_BIT,
+      VMA_MEMORY_USAGE_GPU_ONLY, 0, MEMORY_POOL_TEXTURE);
+
+  // Levels both images hold are copied on the GPU instead of read again
+  uint32_t sharedMip = std::max(entry.targetMip, residentMip);
+  VulkanBuffer *buffer = entry.staged ? entry.staged->buffer : nullptr;
+  std::vector<VkBufferImageCopy> regions;
+  if (entry.staged) {
+    regions = entry.staged->regions;
+  }
+
+  entry.transferValue = entry.targetImage->streamFrom(
+      buffer, regions, source, sharedMip - residentMip,
+      sharedMip - entry.targetMip, mipCount - sharedMip);
+}
+
+void VulkanTextureStreamer::finishTransfers() {
+  VulkanTimeline *timeline = device->getTimeline();
+
+  for (int i = 0; i < textures.size(); i++) {
+    StreamedTexture &entry = textures[i];
+    if (!entry.busy) {
+      continue;
+    }
+
+    if (entry.targetImage == nullptr) {
+      // Still staging on a job
+      if (!entry.staged->ready) {
+        continue;
+      }
+      if (entry.staged->failed) {
+        entry.staged.reset();
+        entry.busy = false;
+        continue;
+      }
+      startTransfer(entry);
+      continue;
+    }
+
+    if (timeline->isComplete(entry.transferValue)) {
+      entry.texture->swapImage(entry.targetImage, entry.targetMip);
+      entry.targetImage = nullptr;
+      entry.staged.reset();
+      entry.busy = false;
+    }
+  }
+}
+
+void VulkanTextureStreamer::evict(VkDeviceSize &residentSize) {
+  std::vector<StreamedTexture *> candidates;
+  for (int i = 0; i < textures.size(); i++) {
+    StreamedTexture &entry = textures[i];
+    uint32_t residentMip = entry.texture->getResidentMip();
+    // Mips drawn this frame stay, evicting them would only stream them back
+    bool needed = entry.lastRequested == updateCount &&
+                  entry.wantedMip <= residentMip;
+    if (!entry.busy && !needed &&
+        residentMip < entry.texture->getStreamingBaseMip()) {
+      candidates.push_back(&entry);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const StreamedTexture *a, const StreamedTexture *b) {
+              return a->lastRequested < b->lastRequested;
+            });
+
+  for (int i = 0; i < candidates.size() && residentSize > budget; i++) {
+    StreamedTexture &entry = *candidates[i];
+    uint32_t residentMip = entry.texture->getResidentMip();
+
+    // One level at a time, the most detailed level holds most of the memory
+    entry.targetMip = residentMip + 1;
+    entry.busy = true;
+    residentSize -= entry.texture->getResidentSize(residentMip) -
+                    entry.texture->getResidentSize(entry.targetMip);
+    startTransfer(entry);
+  }
+}
+
+void VulkanTextureStreamer::update() {
+  std::lock_guard<std::mutex> lock(mutex);
+  updateCount++;
+
+  finishTransfers();
+
+  VkDeviceSize residentSize = 0;
+  for (int i = 0; i < textures.size(); i++) {
+    StreamedTexture &entry = textures[i];
+    uint32_t requested = entry.texture->takeRequestedMip();
+    if (requested < entry.texture->getMipLevels()) {
+      entry.wantedMip = requested;
+      entry.lastRequested = updateCount;
+    } else if (updateCount - entry.lastRequested > TEXTURE_REQUEST_TIMEOUT) {
+      // Out of view, the mips it asked for back then are no longer needed
+      entry.wantedMip = entry.texture->getStreamingBaseMip();
+    }
+
+    // Growth already under way counts as resident
+    uint32_t residentMip = entry.texture->getResidentMip();
+    if (entry.busy) {
+      residentMip = std::min(residentMip, entry.targetMip);
+    }
+    residentSize += entry.texture->getResidentSize(residentMip);
+  }
+
+  for (int i = 0; i < textures.size(); i++) {
+    StreamedTexture &entry = textures[i];
+    uint32_t residentMip = entry.texture->getResidentMip();
+    if (entry.busy) {
+      continue;
+    }
+
+    // Only stale requests shrink here, textures still in view asking for
+    // less are left to eviction so distance changes do not cause churn
+    if (entry.wantedMip > residentMip &&
+        updateCount - entry.lastRequested > TEXTURE_REQUEST_TIMEOUT) {
+      entry.targetMip = residentMip + 1;
+      entry.busy = true;
+      residentSize -= entry.texture->getResidentSize(residentMip) -
+                      entry.texture->getResidentSize(entry.targetMip);
+      startTransfer(entry);
+      continue;
+    }
+
+    if (entry.wantedMip >= residentMip) {
+      continue;
+    }
+
+    VkDeviceSize growth = entry.texture->getResidentSize(entry.wantedMip) -
+                          entry.texture->getResidentSize(residentMip);
+    if (residentSize + growth > budget) {
+      continue;
+    }
+
+    entry.targetMip = entry.wantedMip;
+    entry.busy = true;
+    residentSize += growth;
+    stageMips(entry);
+  }
+
+  if (residentSize > budget) {
+    evict(residentSize);
+  }
+}
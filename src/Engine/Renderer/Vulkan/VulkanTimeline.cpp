@@ -0,0 +1,178 @@
+#include "Engine/Renderer/Vulkan/VulkanTimeline.h"
+
+VulkanTimeline::VulkanTimeline(VkDevice device, bool timelineSupported) {
+  this->device = device;
+  this->timelineSupported = timelineSupported;
+
+  if (!timelineSupported) {
+    spdlog::debug("timeline semaphores unsupported, using fence fallback");
+    return;
+  }
+
+  VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+  typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+  typeInfo.initialValue = 0;
+
+  VkSemaphoreCreateInfo createInfo = {};
+  createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  createInfo.pNext = &typeInfo;
+
+  if (vkCreateSemaphore(device, &createInfo, nullptr, &semaphore) !=
+      VK_SUCCESS) {
+    spdlog::error("failed to create vulkan timeline semaphore");
+    this->timelineSupported = false;
+  } else {
+    spdlog::debug("created vulkan timeline semaphore");
+  }
+}
+
+VulkanTimeline::~VulkanTimeline() {
+  if (semaphore != VK_NULL_HANDLE) {
+    vkDestroySemaphore(device, semaphore, nullptr);
+  }
+
+  for (auto &pending : pendingFences) {
+    vkDestroyFence(device, pending.second, nullptr);
+  }
+
+  for (int i = 0; i < freeFences.size(); i++) {
+    vkDestroyFence(device, freeFences[i], nullptr);
+  }
+}
+
+VkFence VulkanTimeline::acquireFence() {
+  if (!freeFences.empty()) {
+    VkFence fence = freeFences.back();
+    freeFences.pop_back();
+    return fence;
+  }
+
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  VkFence fence;
+  if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+    spdlog::error("failed to create vulkan timeline fence");
+  }
+  return fence;
+}
+
+void VulkanTimeline::retireFences(bool block, uint64_t value) {
+  while (!pendingFences.empty()) {
+    auto &pending = pendingFences.front();
+
+    if (block && pending.first <= value) {
+      vkWaitForFences(device, 1, &pending.second, VK_TRUE, UINT64_MAX);
+    } else if (vkGetFenceStatus(device, pending.second) != VK_SUCCESS) {
+      break;
+    }
+
+    completedValue = pending.first;
+    vkResetFences(device, 1, &pending.second);
+    freeFences.push_back(pending.second);
+    pendingFences.pop_front();
+  }
+}
+
+uint64_t VulkanTimeline::submit(VkQueue queue, const VkSubmitInfo &submitInfo) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint64_t value = lastSubmittedValue + 1;
+  VkSubmitInfo timelineSubmit = submitInfo;
+
+  if (timelineSupported) {
+    uint32_t binaryCount = submitInfo.signalSemaphoreCount;
+    if (binaryCount > TIMELINE_MAX_SIGNAL_SEMAPHORES) {
+      spdlog::error("submission signals more than {0} semaphores",
+                    TIMELINE_MAX_SIGNAL_SEMAPHORES);
+      binaryCount = TIMELINE_MAX_SIGNAL_SEMAPHORES;
+    }
+
+    // Values for binary semaphores are ignored
+    VkSemaphore signalSemaphores[TIMELINE_MAX_SIGNAL_SEMAPHORES + 1];
+    uint64_t signalValues[TIMELINE_MAX_SIGNAL_SEMAPHORES + 1] = {};
+    for (uint32_t i = 0; i < binaryCount; i++) {
+      signalSemaphores[i] = submitInfo.pSignalSemaphores[i];
+    }
+    signalSemaphores[binaryCount] = semaphore;
+    signalValues[binaryCount] = value;
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.pNext = submitInfo.pNext;
+    timelineInfo.signalSemaphoreValueCount = binaryCount + 1;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    timelineSubmit.pNext = &timelineInfo;
+    timelineSubmit.signalSemaphoreCount = binaryCount + 1;
+    timelineSubmit.pSignalSemaphores = signalSemaphores;
+
+    if (vkQueueSubmit(queue, 1, &timelineSubmit, VK_NULL_HANDLE) !=
+        VK_SUCCESS) {
+      spdlog::error("error submitting vulkan queue");
+    }
+  } else {
+    VkFence fence = acquireFence();
+
+    if (vkQueueSubmit(queue, 1, &timelineSubmit, fence) != VK_SUCCESS) {
+      spdlog::error("error submitting vulkan queue");
+    }
+
+    pendingFences.push_back(std::make_pair(value, fence));
+  }
+
+  lastSubmittedValue = value;
+  return value;
+}
+
+VkResult VulkanTimeline::present(VkQueue queue,
+                                 const VkPresentInfoKHR &presentInfo) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return vkQueuePresentKHR(queue, &presentInfo);
+}
+
+uint64_t VulkanTimeline::getCompletedValue() {
+  if (timelineSupported) {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValueKHR(device, semaphore, &value);
+    return value;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  retireFences(false, 0);
+  return completedValue;
+}
+
+uint64_t VulkanTimeline::getLastSubmittedValue() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lastSubmittedValue;
+}
+
+bool VulkanTimeline::isComplete(uint64_t value) {
+  return getCompletedValue() >= value;
+}
+
+void VulkanTimeline::wait(uint64_t value) {
+  if (value == 0) {
+    return;
+  }
+
+  if (timelineSupported) {
+    VkSemaphoreWaitInfoKHR waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+
+    if (vkWaitSemaphoresKHR(device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+      spdlog::error("failed waiting on vulkan timeline semaphore");
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  retireFences(true, value);
+}
+
+bool VulkanTimeline::isTimelineSupported() { return timelineSupported; }
\ No newline at end of file
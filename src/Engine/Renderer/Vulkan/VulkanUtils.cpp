@@ -35,6 +35,23 @@ bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR vkSurface,
   return extensionsSupported;
 }
 
+bool checkInstanceExtensionSupport(const char *extension) {
+  uint32_t extensionCount;
+  vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+  vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount,
+                                         availableExtensions.data());
+
+  for (const auto &availableExtension : availableExtensions) {
+    if (strcmp(extension, availableExtension.extensionName) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool checkDeviceExtensionSupport(VkPhysicalDevice device,
                                  std::vector<const char *> deviceExtensions) {
   uint32_t extensionCount;
@@ -0,0 +1,390 @@
+#include "Engine/Resources/AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "spdlog/spdlog.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t LZ4_MIN_MATCH = 4;
+static const size_t LZ4_LAST_LITERALS = 5;
+static const size_t LZ4_MATCH_FIND_LIMIT = 12;
+static const size_t LZ4_MAX_OFFSET = 65535;
+static const uint32_t LZ4_HASH_LOG = 12;
+
+// Whether [offset, offset + size) lies inside the file, written so crafted
+// offsets and sizes cannot wrap the sum around
+static bool isInFile(uint64_t offset, uint64_t size, size_t fileSize) {
+  return offset <= fileSize && size <= fileSize - offset;
+}
+
+static uint32_t read32(const uint8_t *pointer) {
+  uint32_t value;
+  std::memcpy(&value, pointer, sizeof(value));
+  return value;
+}
+
+static void writeLength(std::vector<uint8_t> &destination, size_t length) {
+  while (length >= 255) {
+    destination.push_back(255);
+    length -= 255;
+  }
+  destination.push_back(static_cast<uint8_t>(length));
+}
+
+static void writeSequence(std::vector<uint8_t> &destination,
+                          const uint8_t *literals, size_t literalLength,
+                          size_t offset, size_t matchLength) {
+  size_t matchCode = matchLength > 0 ? matchLength - LZ4_MIN_MATCH : 0;
+
+  uint8_t token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+  token |= static_cast<uint8_t>(std::min<size_t>(matchCode, 15));
+  destination.push_back(token);
+
+  if (literalLength >= 15) {
+    writeLength(destination, literalLength - 15);
+  }
+  destination.insert(destination.end(), literals, literals + literalLength);
+
+  if (matchLength == 0) {
+    return;
+  }
+
+  destination.push_back(static_cast<uint8_t>(offset & 0xff));
+  destination.push_back(static_cast<uint8_t>(offset >> 8));
+
+  if (matchCode >= 15) {
+    writeLength(destination, matchCode - 15);
+  }
+}
+
+size_t lz4Compress(const uint8_t *source, size_t sourceSize,
+                   std::vector<uint8_t> &destination) {
+  destination.clear();
+
+  // Positions are stored plus one so zero means empty
+  std::vector<uint32_t> table(1 << LZ4_HASH_LOG, 0);
+
+  size_t anchor = 0;
+  size_t position = 0;
+
+  if (sourceSize > LZ4_MATCH_FIND_LIMIT) {
+    size_t limit = sourceSize - LZ4_MATCH_FIND_LIMIT;
+
+    while (position < limit) {
+      uint32_t sequence = read32(source + position);
+      uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+      size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(position + 1);
+
+      if (candidate == 0 || position - (candidate - 1) > LZ4_MAX_OFFSET ||
+          read32(source + candidate - 1) != sequence) {
+        position++;
+        continue;
+      }
+      candidate--;
+
+      size_t matchLength = LZ4_MIN_MATCH;
+      size_t maxMatch = sourceSize - LZ4_LAST_LITERALS - position;
+      while (matchLength < maxMatch &&
+             source[candidate + matchLength] == source[position + matchLength]) {
+        matchLength++;
+      }
+
+      writeSequence(destination, source + anchor, position - anchor,
+                    position - candidate, matchLength);
+
+      position += matchLength;
+      anchor = position;
+    }
+  }
+
+  writeSequence(destination, source + anchor, sourceSize - anchor, 0, 0);
+  return destination.size();
+}
+
+bool lz4Decompress(const uint8_t *source, size_t sourceSize,
+                   uint8_t *destination, size_t destinationSize) {
+  size_t in = 0;
+  size_t out = 0;
+
+  while (in < sourceSize) {
+    uint8_t token = source[in++];
+
+    size_t literalLength = token >> 4;
+    if (literalLength == 15) {
+      uint8_t extra;
+      do {
+        if (in >= sourceSize) {
+          return false;
+        }
+        extra = source[in++];
+        literalLength += extra;
+      } while (extra == 255);
+    }
+
+    if (in + literalLength > sourceSize ||
+        out + literalLength > destinationSize) {
+      return false;
+    }
+    if (literalLength > 0) {
+      std::memcpy(destination + out, source + in, literalLength);
+    }
+    in += literalLength;
+    out += literalLength;
+
+    // The last sequence only carries literals
+    if (in == sourceSize) {
+      break;
+    }
+
+    if (in + 2 > sourceSize) {
+      return false;
+    }
+    size_t offset = source[in] | (source[in + 1] << 8);
+    in += 2;
+
+    if (offset == 0 || offset > out) {
+      return false;
+    }
+
+    size_t matchLength = token & 0x0f;
+    if (matchLength == 15) {
+      uint8_t extra;
+      do {
+        if (in >= sourceSize) {
+          return false;
+        }
+        extra = source[in++];
+        matchLength += extra;
+      } while (extra == 255);
+    }
+    matchLength += LZ4_MIN_MATCH;
+
+    if (out + matchLength > destinationSize) {
+      return false;
+    }
+
+    // Matches may overlap the bytes they produce, copy forwards one at a time
+    for (size_t i = 0; i < matchLength; i++) {
+      destination[out + i] = destination[out - offset + i];
+    }
+    out += matchLength;
+  }
+
+  return out == destinationSize;
+}
+
+AssetArchive::AssetArchive() {}
+
+AssetArchive::~AssetArchive() { close(); }
+
+void AssetArchive::close() {
+#ifdef _WIN32
+  fileContents.clear();
+#else
+  if (data != nullptr) {
+    munmap(const_cast<uint8_t *>(data), dataSize);
+  }
+  if (fileDescriptor >= 0) {
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+  }
+#endif
+  data = nullptr;
+  dataSize = 0;
+  entries = nullptr;
+  entryCount = 0;
+}
+
+bool AssetArchive::open(const std::string &path) {
+  close();
+
+#ifdef _WIN32
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  fileContents.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(fileContents.data()), fileContents.size());
+  data = fileContents.data();
+  dataSize = fileContents.size();
+#else
+  fileDescriptor = ::open(path.c_str(), O_RDONLY);
+  if (fileDescriptor < 0) {
+    return false;
+  }
+
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+    close();
+    return false;
+  }
+
+  void *mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size),
+                      PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (mapped == MAP_FAILED) {
+    spdlog::error("failed to map asset archive {0}", path);
+    close();
+    return false;
+  }
+
+  data = static_cast<const uint8_t *>(mapped);
+  dataSize = static_cast<size_t>(fileStat.st_size);
+#endif
+
+  ArchiveHeader header;
+  if (dataSize < sizeof(ArchiveHeader)) {
+    spdlog::error("asset archive {0} is truncated", path);
+    close();
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(ArchiveHeader));
+
+  if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+      header.version != ARCHIVE_VERSION ||
+      header.tocOffset % alignof(ArchiveEntry) != 0 ||
+      !isInFile(header.tocOffset,
+                static_cast<uint64_t>(header.entryCount) * sizeof(ArchiveEntry),
+                dataSize)) {
+    spdlog::error("asset archive {0} is invalid", path);
+    close();
+    return false;
+  }
+
+  entries = reinterpret_cast<const ArchiveEntry *>(data + header.tocOffset);
+  entryCount = header.entryCount;
+
+  spdlog::info("mounted asset archive {0} with {1} entries", path, entryCount);
+  return true;
+}
+
+const ArchiveEntry *AssetArchive::find(uint64_t pathHash) {
+  const ArchiveEntry *end = entries + entryCount;
+  const ArchiveEntry *entry = std::lower_bound(
+      entries, end, pathHash, [](const ArchiveEntry &entry, uint64_t hash) {
+        return entry.pathHash < hash;
+      });
+
+  if (entry == end || entry->pathHash != pathHash) {
+    return nullptr;
+  }
+  return entry;
+}
+
+bool AssetArchive::contains(const std::string &path) {
+  return data != nullptr && find(hashPath(path)) != nullptr;
+}
+
+bool AssetArchive::read(const std::string &path, std::vector<char> &contents) {
+  if (data == nullptr) {
+    return false;
+  }
+
+  const ArchiveEntry *entry = find(hashPath(path));
+  if (entry == nullptr ||
+      !isInFile(entry->offset, entry->storedSize, dataSize)) {
+    return false;
+  }
+
+  contents.resize(static_cast<size_t>(entry->size));
+
+  if (entry->compression == ARCHIVE_COMPRESSION_LZ4) {
+    if (!lz4Decompress(data + entry->offset, entry->storedSize,
+                       reinterpret_cast<uint8_t *>(contents.data()),
+                       contents.size())) {
+      spdlog::error("failed to decompress {0} from asset archive", path);
+      return false;
+    }
+  } else if (entry->size != entry->storedSize) {
+    spdlog::error("{0} in asset archive has a mismatched size", path);
+    return false;
+  } else if (!contents.empty()) {
+    std::memcpy(contents.data(), data + entry->offset, contents.size());
+  }
+
+  return true;
+}
+
+uint32_t AssetArchive::getEntryCount() { return entryCount; }
+
+bool AssetArchive::write(
+    const std::string &path,
+    const std::vector<std::pair<std::string, std::vector<char>>> &files,
+    bool compress) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  ArchiveHeader header = {};
+  std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+  header.version = ARCHIVE_VERSION;
+  header.entryCount = static_cast<uint32_t>(files.size());
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<ArchiveEntry> toc;
+  uint64_t offset = sizeof(header);
+  std::vector<uint8_t> compressed;
+
+  for (int i = 0; i < files.size(); i++) {
+    const std::vector<char> &contents = files[i].second;
+
+    ArchiveEntry entry = {};
+    entry.pathHash = hashPath(files[i].first);
+    entry.offset = offset;
+    entry.size = contents.size();
+    entry.storedSize = contents.size();
+    entry.compression = ARCHIVE_COMPRESSION_NONE;
+
+    const char *stored = contents.data();
+
+    // Only keep the compressed copy when it actually saves space
+    if (compress && !contents.empty() &&
+        lz4Compress(reinterpret_cast<const uint8_t *>(contents.data()),
+                    contents.size(), compressed) < contents.size()) {
+      entry.storedSize = compressed.size();
+      entry.compression = ARCHIVE_COMPRESSION_LZ4;
+      stored = reinterpret_cast<const char *>(compressed.data());
+    }
+
+    file.write(stored, static_cast<std::streamsize>(entry.storedSize));
+    offset += entry.storedSize;
+    toc.push_back(entry);
+  }
+
+  std::sort(toc.begin(), toc.end(),
+            [](const ArchiveEntry &a, const ArchiveEntry &b) {
+              return a.pathHash < b.pathHash;
+            });
+
+  for (int i = 1; i < toc.size(); i++) {
+    if (toc[i].pathHash == toc[i - 1].pathHash) {
+      spdlog::error("asset archive path hash collision");
+      return false;
+    }
+  }
+
+  // Keep the table of contents aligned for direct access from the mapping
+  uint64_t padding = (alignof(ArchiveEntry) - offset % alignof(ArchiveEntry)) %
+                     alignof(ArchiveEntry);
+  std::vector<char> zeros(static_cast<size_t>(padding), 0);
+  file.write(zeros.data(), static_cast<std::streamsize>(padding));
+  header.tocOffset = offset + padding;
+
+  file.write(reinterpret_cast<const char *>(toc.data()),
+             static_cast<std::streamsize>(toc.size() * sizeof(ArchiveEntry)));
+
+  file.seekp(0);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  return static_cast<bool>(file);
+}
\ No newline at end of file
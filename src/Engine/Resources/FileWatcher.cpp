@@ -0,0 +1,133 @@
+#include "Engine/Resources/FileWatcher.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher(
+    const std::string &root,
+    std::function<void(const std::vector<std::string> &)> callback) {
+  this->root = root;
+  this->callback = callback;
+
+#ifdef __linux__
+  inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyDescriptor < 0) {
+    spdlog::error("failed to initialise inotify for {0}", root);
+    return;
+  }
+
+  addDirectory(root);
+  running = true;
+  watchThread = std::thread(&FileWatcher::watchLoop, this);
+  spdlog::info("watching {0} for changes", root);
+#else
+  spdlog::info("file watching is not supported on this platform");
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+  running = false;
+  if (watchThread.joinable()) {
+    watchThread.join();
+  }
+
+#ifdef __linux__
+  if (inotifyDescriptor >= 0) {
+    close(inotifyDescriptor);
+  }
+#endif
+}
+
+bool FileWatcher::isWatching() { return running; }
+
+void FileWatcher::addDirectory(const std::string &path) {
+#ifdef __linux__
+  int watch = inotify_add_watch(inotifyDescriptor, path.c_str(),
+                                IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  if (watch < 0) {
+    spdlog::error("failed to watch directory {0}", path);
+    return;
+  }
+  watchedDirectories[watch] = path;
+
+  DIR *directory = opendir(path.c_str());
+  if (directory == nullptr) {
+    return;
+  }
+
+  struct dirent *child;
+  while ((child = readdir(directory)) != nullptr) {
+    std::string name = child->d_name;
+    if (child->d_type == DT_DIR && name != "." && name != "..") {
+      addDirectory(path + "/" + name);
+    }
+  }
+  closedir(directory);
+#endif
+}
+
+bool FileWatcher::readEvents(int timeoutMs, std::vector<std::string> &changed) {
+#ifdef __linux__
+  pollfd descriptor = {};
+  descriptor.fd = inotifyDescriptor;
+  descriptor.events = POLLIN;
+
+  if (poll(&descriptor, 1, timeoutMs) <= 0) {
+    return false;
+  }
+
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0) {
+    for (char *cursor = buffer; cursor < buffer + length;) {
+      inotify_event *event = reinterpret_cast<inotify_event *>(cursor);
+      cursor += sizeof(inotify_event) + event->len;
+
+      auto directory = watchedDirectories.find(event->wd);
+      if (directory == watchedDirectories.end() || event->len == 0) {
+        continue;
+      }
+
+      std::string path = directory->second + "/" + event->name;
+      if (event->mask & IN_ISDIR) {
+        // New directories are watched from now on, their files are reported
+        // once written
+        addDirectory(path);
+      } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        changed.push_back(path);
+      }
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void FileWatcher::watchLoop() {
+  while (running) {
+    std::vector<std::string> changed;
+    if (!readEvents(FILE_WATCHER_POLL_MS, changed)) {
+      continue;
+    }
+
+    while (running && readEvents(FILE_WATCHER_SETTLE_MS, changed)) {
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    if (!changed.empty()) {
+      for (int i = 0; i < changed.size(); i++) {
+        spdlog::debug("file changed: {0}", changed[i]);
+      }
+      callback(changed);
+    }
+  }
+}
@@ -1,66 +1,404 @@
 #include "Engine/Resources/ResourceManager.h"
 
+#include <cstring>
+#include <iterator>
+
 ResourceManager *ResourceManager::instance = 0;
 
-ResourceManager::ResourceManager() {
-  resourceMap = std::unordered_map<std::string, std::weak_ptr<Resource>>();
+// Files read by the factory currently loading on this thread, if any
+static thread_local std::vector<uint64_t> *recordedDependencies = nullptr;
+
+ResourceManager::ResourceManager() {}
+
+size_t ResourceManager::getEntrySize(const ResourceEntry &entry) {
+  return entry.resource->getCpuSize() + entry.resource->getGpuSize();
+}
+
+std::shared_ptr<Resource> ResourceManager::share(uint64_t hash,
+                                                 ResourceEntry &entry) {
+  std::shared_ptr<Resource> shared = entry.shared.lock();
+  if (shared == nullptr) {
+    // The deleter owns a strong reference, so a resource retired while
+    // shared stays alive until the last outside reference is gone
+    std::shared_ptr<Resource> owned = entry.resource;
+    shared = std::shared_ptr<Resource>(
+        owned.get(), [this, hash, owned](Resource *resource) {
+          onShareReleased(hash, resource);
+        });
+    entry.shared = shared;
+    leaveCache(entry);
+  }
+  return shared;
+}
+
+void ResourceManager::onShareReleased(uint64_t hash, Resource *resource) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
+  // Evicted entries are never shared, reloaded ones replaced the resource,
+  // and another thread may have shared it again before we got the lock
+  ResourceEntry *entry = resourceMap.find(hash);
+  if (entry != nullptr && entry->resource.get() == resource &&
+      entry->shared.expired()) {
+    enterCache(*entry);
+  }
+}
+
+void ResourceManager::enterCache(ResourceEntry &entry) {
+  if (entry.cached) {
+    return;
+  }
+  entry.cached = true;
+  entry.cachedSize = getEntrySize(entry);
+  cachedCount++;
+  cachedBytes += entry.cachedSize;
+}
+
+void ResourceManager::leaveCache(ResourceEntry &entry) {
+  if (!entry.cached) {
+    return;
+  }
+  entry.cached = false;
+  cachedCount--;
+  cachedBytes -= entry.cachedSize;
 }
 
 void ResourceManager::registerFactory(ResourceFactory *factory) {
-  factoryMap[factory->resourceType] = std::unique_ptr<ResourceFactory>(factory);
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  factoryMap.insert(hashPath(factory->resourceType)) = factory;
+  factories.push_back(std::unique_ptr<ResourceFactory>(factory));
+}
+
+bool ResourceManager::mountArchive(const std::string &path) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  archiveMounted = archive.open(path);
+  return archiveMounted;
 }
 
-std::shared_ptr<Resource> ResourceManager::loadResource(std::string filepath) {
-  SDL_RWops *sdlFile = SDL_RWFromFile(filepath.c_str(), "rb");
+bool ResourceManager::readFile(const std::string &path,
+                               std::vector<char> &contents) {
+  if (recordedDependencies != nullptr) {
+    recordedDependencies->push_back(hashPath(path));
+  }
+
+  if (archiveMounted && archive.read(path, contents)) {
+    return true;
+  }
+
+  SDL_RWops *sdlFile = SDL_RWFromFile(path.c_str(), "rb");
 
   if (sdlFile == nullptr) {
     spdlog::error(SDL_GetError());
+    return false;
   }
 
   int size = SDL_RWsize(sdlFile);
-  std::vector<char> buffer(size);
-  SDL_RWread(sdlFile, buffer.data(), size, 1);
+  contents.resize(size);
+  SDL_RWread(sdlFile, contents.data(), size, 1);
 
   SDL_RWclose(sdlFile);
+  return true;
+}
+
+std::shared_ptr<Resource> ResourceManager::loadWithDependencies(
+    ResourceFactory *factory, const std::string &filepath,
+    std::vector<uint64_t> &dependencies) {
+  // Nested loads record into their own list, restore ours afterwards
+  std::vector<uint64_t> *previous = recordedDependencies;
+  recordedDependencies = &dependencies;
+  dependencies.push_back(hashPath(filepath));
+  std::shared_ptr<Resource> resource = factory->load(filepath);
+  recordedDependencies = previous;
+  return resource;
+}
 
-  std::string resourceData(buffer.begin(), buffer.end());
+std::shared_ptr<Resource>
+ResourceManager::loadResource(uint64_t hash, const std::string &filepath) {
+  std::vector<char> buffer;
+  if (!readFile(filepath, buffer)) {
+    spdlog::error("failed to read resource {0}", filepath);
+    return nullptr;
+  }
 
   rapidjson::Document document;
-  document.Parse(resourceData.c_str());
+  document.Parse(buffer.data(), buffer.size());
+
+  if (document.HasParseError() || !document.IsObject() ||
+      !document.HasMember("type") || !document["type"].IsString()) {
+    spdlog::error("no resource type in {0}", filepath);
+    return nullptr;
+  }
+
+  const char *resourceType = document["type"].GetString();
+  ResourceFactory **factory =
+      factoryMap.find(hashPath(resourceType, strlen(resourceType)));
 
-  std::string resourceType = document["type"].GetString();
+  if (factory == nullptr) {
+    spdlog::error("no factory registered for resource type {0} of {1}",
+                  resourceType, filepath);
+    return nullptr;
+  }
+
+  std::vector<uint64_t> dependencies;
   std::shared_ptr<Resource> resource =
-      (factoryMap[resourceType]->load(filepath));
-  resourceMap[filepath] = std::weak_ptr<Resource>(resource);
+      loadWithDependencies(*factory, filepath, dependencies);
+  if (resource == nullptr) {
+    spdlog::error("failed to load resource {0}", filepath);
+    return nullptr;
+  }
+
+  ResourceEntry &entry = resourceMap.insert(hash);
+  if (entry.resource == nullptr) {
+    entry.lruPosition = lruList.insert(lruList.end(), hash);
+  } else {
+    lruList.splice(lruList.end(), lruList, entry.lruPosition);
+    leaveCache(entry);
+    entry.shared.reset();
+  }
+  entry.resource = resource;
+  entry.path = filepath;
+  entry.factory = *factory;
+  entry.dependencies = dependencies;
+  // Cached until the caller shares it
+  enterCache(entry);
   return resource;
 }
 
-std::shared_ptr<Resource> ResourceManager::getResource(std::string filepath) {
-  std::unordered_map<std::string, std::weak_ptr<Resource>>::iterator it =
-      resourceMap.find(filepath);
+ResourceManager::ResourceEntry *ResourceManager::findEntry(uint64_t hash,
+                                                          const char *path) {
+  ResourceEntry *entry = resourceMap.find(hash);
+
+  if (entry != nullptr) {
+    if (entry->path != path) {
+      spdlog::error("resource path hash collision between {0} and {1}",
+                    entry->path, path);
+      return nullptr;
+    }
 
-  if (it != resourceMap.end()) {
-    if (!resourceMap[filepath].expired()) {
-      return resourceMap[filepath].lock();
+    // Lookups of resources still in use elsewhere are not served by the
+    // cache and count as neither
+    if (entry->cached) {
+      stats.hits++;
     }
+    lruList.splice(lruList.end(), lruList, entry->lruPosition);
+    return entry;
+  }
+
+  stats.misses++;
+  if (loadResource(hash, path) == nullptr) {
+    return nullptr;
   }
-  return loadResource(filepath);
+  // Loading can insert dependencies and move entries, so look it up again
+  return resourceMap.find(hash);
+}
+
+std::shared_ptr<Resource> ResourceManager::getResource(const ResourceId &id) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  ResourceEntry *entry = findEntry(id.hash, id.path);
+  return entry != nullptr ? share(id.hash, *entry) : nullptr;
+}
+
+std::shared_ptr<Resource>
+ResourceManager::getResource(const std::string &filepath) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  uint64_t hash = hashPath(filepath);
+  ResourceEntry *entry = findEntry(hash, filepath.c_str());
+  return entry != nullptr ? share(hash, *entry) : nullptr;
 }
 
 std::vector<std::shared_ptr<Resource>>
 ResourceManager::getResources(RESOURCE_TYPE type) {
-  std::unordered_map<std::string, std::weak_ptr<Resource>>::iterator it =
-      resourceMap.begin();
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
   std::vector<std::shared_ptr<Resource>> resources;
-  for (it; it != resourceMap.end(); it++) {
-    if (!it->second.expired()) {
-      std::shared_ptr<Resource> resource = it->second.lock();
-      if (resource->getResourceType() == type) {
-        resources.push_back(resource);
+  resourceMap.forEach([&](uint64_t hash, ResourceEntry &entry) {
+    if (!entry.cached && entry.resource->getResourceType() == type) {
+      resources.push_back(share(hash, entry));
+    }
+  });
+  return resources;
+}
+
+void ResourceManager::reloadChanged(const std::vector<std::string> &files) {
+  std::vector<uint64_t> changed;
+  for (int i = 0; i < files.size(); i++) {
+    changed.push_back(hashPath(files[i]));
+  }
+
+  struct ReloadTarget {
+    uint64_t hash;
+    std::string path;
+    ResourceFactory *factory;
+  };
+  std::vector<ReloadTarget> targets;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    resourceMap.forEach([&](uint64_t hash, ResourceEntry &entry) {
+      if (entry.factory == nullptr || !entry.factory->supportsReload()) {
+        return;
       }
+      for (int i = 0; i < entry.dependencies.size(); i++) {
+        if (std::find(changed.begin(), changed.end(), entry.dependencies[i]) !=
+            changed.end()) {
+          targets.push_back({hash, entry.path, entry.factory});
+          return;
+        }
+      }
+    });
+  }
+
+  // Rebuilding happens without the lock so frames keep resolving resources
+  for (int i = 0; i < targets.size(); i++) {
+    PendingReload reload;
+    reload.hash = targets[i].hash;
+    reload.resource = loadWithDependencies(
+        targets[i].factory, targets[i].path, reload.dependencies);
+
+    if (reload.resource == nullptr) {
+      spdlog::error("failed to reload {0}, keeping the previous version",
+                    targets[i].path);
+      continue;
     }
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    pendingReloads.push_back(reload);
   }
-  return resources;
+}
+
+void ResourceManager::applyReloads() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
+  for (int i = 0; i < pendingReloads.size(); i++) {
+    PendingReload &reload = pendingReloads[i];
+    ResourceEntry *entry = resourceMap.find(reload.hash);
+    if (entry == nullptr) {
+      // Evicted while it was being rebuilt, nothing refers to it any more
+      continue;
+    }
+
+    // References to the previous version keep it alive through their own
+    // deleter, the new one starts out cached
+    retire(entry->resource);
+    leaveCache(*entry);
+    entry->resource = reload.resource;
+    entry->shared.reset();
+    entry->dependencies = reload.dependencies;
+    enterCache(*entry);
+    if (entry->handleIndex != UINT32_MAX) {
+      entry->rebindHandle(entry->handleIndex, share(reload.hash, *entry));
+    }
+    spdlog::info("reloaded {0}", entry->path);
+  }
+  pendingReloads.clear();
+}
+
+void ResourceManager::retire(const std::shared_ptr<Resource> &resource) {
+  RetiredResource retired;
+  retired.resource = resource;
+  retired.frame = frameCount;
+  retiredResources.push_back(retired);
+}
+
+void ResourceManager::collectRetired() {
+  std::vector<RetiredResource> expired;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    frameCount++;
+
+    // Retired in frame order, so the expired ones are at the front
+    size_t count = 0;
+    while (count < retiredResources.size() &&
+           retiredResources[count].frame + RESOURCE_RETIRE_FRAMES <=
+               frameCount) {
+      count++;
+    }
+    expired.assign(std::make_move_iterator(retiredResources.begin()),
+                   std::make_move_iterator(retiredResources.begin() + count));
+    retiredResources.erase(retiredResources.begin(),
+                           retiredResources.begin() + count);
+  }
+  // Destroyed outside the lock, destructors may release other resources
+}
+
+void ResourceManager::flushRetired() {
+  std::vector<RetiredResource> expired;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    expired.swap(retiredResources);
+  }
+}
+
+void ResourceManager::setCacheBudget(size_t bytes) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  cacheBudget = bytes;
+}
+
+void ResourceManager::trimCache() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
+  // A zero budget caches nothing, including resources that report no size
+  auto overBudget = [this]() {
+    return cacheBudget == 0 ? cachedCount > 0 : cachedBytes > cacheBudget;
+  };
+
+  // Resources freed by an eviction release their dependencies only once
+  // retired, those are picked up by a later call
+  auto position = lruList.begin();
+  while (position != lruList.end() && overBudget()) {
+    uint64_t hash = *position;
+    ResourceEntry *entry = resourceMap.find(hash);
+    if (!entry->cached) {
+      ++position;
+      continue;
+    }
+
+    spdlog::debug("evicting cached resource {0}", entry->path);
+    position = lruList.erase(position);
+    leaveCache(*entry);
+    retire(entry->resource);
+    resourceMap.erase(hash);
+    stats.evictions++;
+  }
+}
+
+ResourceCacheStats ResourceManager::getCacheStats() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
+  ResourceCacheStats result = stats;
+  result.cacheBudget = cacheBudget;
+
+  resourceMap.forEach([&](uint64_t hash, ResourceEntry &entry) {
+    result.residentCpuBytes += entry.resource->getCpuSize();
+    result.residentGpuBytes += entry.resource->getGpuSize();
+  });
+  result.cachedBytes = cachedBytes;
+
+  return result;
+}
+
+std::vector<ResourceTypeStats> ResourceManager::getTypeStats() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+
+  std::vector<ResourceTypeStats> result;
+  resourceMap.forEach([&](uint64_t hash, ResourceEntry &entry) {
+    RESOURCE_TYPE type = entry.resource->getResourceType();
+
+    int index = 0;
+    while (index < result.size() && result[index].type != type) {
+      index++;
+    }
+    if (index == result.size()) {
+      ResourceTypeStats typeStats;
+      typeStats.type = type;
+      result.push_back(typeStats);
+    }
+
+    result[index].count++;
+    result[index].cpuBytes += entry.resource->getCpuSize();
+    result[index].gpuBytes += entry.resource->getGpuSize();
+  });
+
+  return result;
 }
 
 ResourceManager *ResourceManager::getInstance() {
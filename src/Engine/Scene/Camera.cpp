@@ -0,0 +1,75 @@
+#include "Engine/Scene/Camera.h"
+
+#include <cmath>
+
+Camera::Camera(uint32_t width, uint32_t height)
+{
+  this->width = width;
+  this->height = height;
+  updateView();
+  updateProjection();
+}
+
+Camera::~Camera() {
+
+}
+
+void Camera::updateView() {
+  view = glm::lookAt(eye, target, up);
+  viewProjection = projection * view;
+}
+
+void Camera::updateProjection() {
+  float aspect = static_cast<float>(width) / static_cast<float>(height > 0 ? height : 1);
+  projection = glm::perspective(fov, aspect, nearPlane, farPlane);
+  // Vulkan clip space has an inverted y compared to OpenGL
+  projection[1][1] *= -1;
+  viewProjection = projection * view;
+}
+
+void Camera::lookAt(glm::vec3 eye, glm::vec3 target, glm::vec3 up) {
+  this->eye = eye;
+  this->target = target;
+  this->up = up;
+  updateView();
+}
+
+void Camera::setPerspective(float fov, float nearPlane, float farPlane) {
+  this->fov = fov;
+  this->nearPlane = nearPlane;
+  this->farPlane = farPlane;
+  updateProjection();
+}
+
+void Camera::setExtent(uint32_t width, uint32_t height) {
+  if (this->width == width && this->height == height) {
+    return;
+  }
+
+  spdlog::debug("camera extent changed to {0} {1}", width, height);
+
+  this->width = width;
+  this->height = height;
+  updateProjection();
+}
+
+const glm::mat4 &Camera::getView() {
+  return view;
+}
+
+const glm::mat4 &Camera::getProjection() {
+  return projection;
+}
+
+const glm::mat4 &Camera::getViewProjection() {
+  return viewProjection;
+}
+
+float Camera::getProjectedSize(glm::vec3 position, float radius) {
+  float distance = glm::length(position - eye);
+  // Inside the sphere it covers the whole view
+  if (distance <= radius) {
+    return static_cast<float>(height);
+  }
+  return radius * static_cast<float>(height) / (distance * std::tan(fov * 0.5f));
+}
@@ -0,0 +1,62 @@
+#include "Engine/Scene/EntityRegistry.h"
+
+#include "spdlog/spdlog.h"
+
+uint32_t EntityRegistry::nextComponentTypeId() {
+  static std::atomic<uint32_t> nextId{0};
+  return nextId++;
+}
+
+EntityRegistry::~EntityRegistry() {
+  for (int i = 0; i < pools.size(); i++) {
+    delete pools[i];
+  }
+}
+
+Entity EntityRegistry::create() {
+  uint32_t index;
+  if (!freeIndices.empty()) {
+    index = freeIndices.back();
+    freeIndices.pop_back();
+  } else {
+    index = static_cast<uint32_t>(generations.size());
+    if (index > ENTITY_INDEX_MASK) {
+      spdlog::error("out of entity ids");
+      return NULL_ENTITY;
+    }
+    generations.push_back(0);
+  }
+
+  entityCount++;
+  return makeEntity(index, generations[index]);
+}
+
+void EntityRegistry::destroy(Entity entity) {
+  if (!isAlive(entity)) {
+    return;
+  }
+
+  for (int i = 0; i < pools.size(); i++) {
+    if (pools[i] != nullptr) {
+      pools[i]->remove(entity);
+    }
+  }
+
+  uint32_t index = getEntityIndex(entity);
+  generations[index]++;
+  entityCount--;
+
+  // Reusing the index past the last generation would repeat an old id, and
+  // the top generation of the top index would equal NULL_ENTITY
+  if (generations[index] < ENTITY_MAX_GENERATION) {
+    freeIndices.push_back(index);
+  }
+}
+
+bool EntityRegistry::isAlive(Entity entity) const {
+  uint32_t index = getEntityIndex(entity);
+  return entity != NULL_ENTITY && index < generations.size() &&
+         generations[index] == getEntityGeneration(entity);
+}
+
+uint32_t EntityRegistry::getEntityCount() const { return entityCount; }
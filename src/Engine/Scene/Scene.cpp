@@ -1,27 +1,187 @@
 #include "Engine/Scene/Scene.h"
 
+#include <algorithm>
+
+Scene::Scene() {
+  startTime = std::chrono::high_resolution_clock::now();
+
+  // Systems look pools up from job threads, where creating one would race
+  registry.getPool<Transform>();
+  registry.getPool<MeshRenderer>();
+  registry.getPool<Bounds>();
+  registry.getPool<Spin>();
+  registry.getPool<Camera>();
+}
+
 Scene::~Scene() {
-  for (int i = 0; i< nodeList.size(); i++) {
-    delete nodeList[i];
+  ComponentPool<MeshRenderer>& renderers = registry.getPool<MeshRenderer>();
+  for (uint32_t i = 0; i < renderers.size(); i++) {
+    ResourceManager::getInstance()->release(renderers.data()[i].meshInstance);
+  }
+}
+
+Entity Scene::createActor(ResourceHandle<VulkanMeshInstanceResource> meshInstance) {
+  Entity entity = registry.create();
+  registry.add<Transform>(entity);
+
+  MeshRenderer renderer;
+  renderer.meshInstance = meshInstance;
+  registry.add<MeshRenderer>(entity, renderer);
+
+  Bounds bounds;
+  VulkanMeshInstanceResource* resolved = ResourceManager::resolve(meshInstance);
+  if (resolved != nullptr && resolved->getMesh() != nullptr) {
+    bounds.sphere = resolved->getMesh()->getBounds();
+  }
+  registry.add<Bounds>(entity, bounds);
+  return entity;
+}
+
+Entity Scene::createCamera(uint32_t width, uint32_t height) {
+  Entity entity = registry.create();
+  registry.add<Camera>(entity, Camera(width, height));
+  return entity;
+}
+
+void Scene::destroyEntity(Entity entity) {
+  MeshRenderer* renderer = registry.get<MeshRenderer>(entity);
+  if (renderer != nullptr) {
+    ResourceManager::getInstance()->release(renderer->meshInstance);
   }
+
+  if (entity == activeCamera) {
+    activeCamera = NULL_ENTITY;
+  }
+  registry.destroy(entity);
 }
 
-void Scene::addNode(Node* node) {
-  nodeList.push_back(node);
+EntityRegistry& Scene::getRegistry() {
+  return registry;
 }
 
-std::vector<Node*> Scene::getMeshDrawList() {
-  std::vector<Node*> drawList;
-  for (int i = 0; i < nodeList.size(); i++) {
-    if (nodeList[i]->getNodeType() == ACTOR) {
-      drawList.push_back(nodeList[i]);
+void Scene::setActiveCamera(Entity camera) {
+  activeCamera = camera;
+}
+
+Camera* Scene::getActiveCamera() {
+  return registry.get<Camera>(activeCamera);
+}
+
+const std::vector<Entity>& Scene::getMeshDrawList() {
+  ComponentPool<MeshRenderer>& renderers = registry.getPool<MeshRenderer>();
+  ComponentPool<Transform>& transforms = registry.getPool<Transform>();
+
+  drawList.clear();
+  drawList.reserve(renderers.size());
+
+  const Entity* entities = renderers.getEntities();
+  for (uint32_t i = 0; i < renderers.size(); i++) {
+    if (transforms.has(entities[i])) {
+      drawList.push_back(entities[i]);
     }
   }
   return drawList;
 }
 
-void Scene::update() {
-  for (int i = 0; i < nodeList.size(); i++) {
-    nodeList[i]->update();
+void Scene::buildSnapshot(RenderSnapshot& snapshot) {
+  getMeshDrawList();
+
+  Camera* camera = getActiveCamera();
+  if (camera != nullptr) {
+    snapshot.viewProjection = camera->getViewProjection();
   }
-}
\ No newline at end of file
+
+  // Snapshot slots are reused, so this only allocates when the scene grows
+  snapshot.meshDraws.resize(drawList.size());
+  snapshot.changedDraws.resize(drawList.size());
+  publishedDraws.resize(drawList.size());
+  changedDrawCount = 0;
+
+  // Captures stay within std::function's inline storage, anything larger
+  // would be heap allocated every frame
+  JobSystem::getInstance()->parallelFor(static_cast<uint32_t>(drawList.size()), SCENE_JOB_GRAIN_SIZE, [this, &snapshot](uint32_t begin, uint32_t end) {
+    ComponentPool<MeshRenderer>& renderers = registry.getPool<MeshRenderer>();
+    ComponentPool<Transform>& transforms = registry.getPool<Transform>();
+    ComponentPool<Bounds>& bounds = registry.getPool<Bounds>();
+    Camera* camera = registry.get<Camera>(activeCamera);
+
+    // Changed draws are gathered per job and appended in one go
+    uint32_t changed[SCENE_JOB_GRAIN_SIZE];
+    uint32_t changedCount = 0;
+    auto flushChanged = [&]() {
+      uint32_t offset = changedDrawCount.fetch_add(changedCount);
+      std::copy(changed, changed + changedCount, snapshot.changedDraws.begin() + offset);
+      changedCount = 0;
+    };
+
+    for (uint32_t i = begin; i < end; i++) {
+      Entity entity = drawList[i];
+      ResourceHandle<VulkanMeshInstanceResource> handle = renderers.get(entity)->meshInstance;
+      const glm::mat4& model = transforms.get(entity)->model;
+      snapshot.meshDraws[i].meshInstance = handle;
+      snapshot.meshDraws[i].model = model;
+
+      MeshDraw& published = publishedDraws[i];
+      if (published.meshInstance.index != handle.index || published.meshInstance.generation != handle.generation || published.model != model) {
+        published = snapshot.meshDraws[i];
+        changed[changedCount++] = i;
+        if (changedCount == SCENE_JOB_GRAIN_SIZE) {
+          flushChanged();
+        }
+      }
+
+      // Ask the texture streamer for the mips this entity needs at its
+      // current screen size
+      VulkanMeshInstanceResource* meshInstance = ResourceManager::resolve(handle);
+      VulkanTextureResource* texture = meshInstance != nullptr ? meshInstance->getTexture() : nullptr;
+      Bounds* entityBounds = bounds.get(entity);
+      if (texture != nullptr && camera != nullptr && entityBounds != nullptr) {
+        glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(entityBounds->sphere), 1.0f));
+        float scale = glm::max(glm::length(glm::vec3(model[0])), glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float size = camera->getProjectedSize(center, entityBounds->sphere.w * scale);
+        texture->requestMip(texture->getMipForScreenSize(size));
+      }
+    }
+    flushChanged();
+  });
+  snapshot.changedDrawCount = changedDrawCount;
+}
+
+void Scene::updateSpin(float time) {
+  uint32_t count = registry.getPool<Spin>().size();
+  JobSystem::getInstance()->parallelFor(count, SCENE_JOB_GRAIN_SIZE, [this, time](uint32_t begin, uint32_t end) {
+    ComponentPool<Spin>& spins = registry.getPool<Spin>();
+    ComponentPool<Transform>& transforms = registry.getPool<Transform>();
+    Spin* spinData = spins.data();
+    const Entity* entities = spins.getEntities();
+
+    for (uint32_t i = begin; i < end; i++) {
+      Transform* transform = transforms.get(entities[i]);
+      if (transform != nullptr) {
+        transform->rotation = glm::angleAxis(time * spinData[i].radiansPerSecond, spinData[i].axis);
+      }
+    }
+  });
+}
+
+void Scene::updateTransforms() {
+  ComponentPool<Transform>& transforms = registry.getPool<Transform>();
+
+  Transform* transformData = transforms.data();
+  JobSystem::getInstance()->parallelFor(transforms.size(), SCENE_JOB_GRAIN_SIZE, [transformData](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      Transform& transform = transformData[i];
+      transform.model = glm::translate(glm::mat4(1.0f), transform.translation) *
+                        glm::mat4_cast(transform.rotation) *
+                        glm::scale(glm::mat4(1.0f), transform.scale);
+    }
+  });
+}
+
+void Scene::update() {
+  auto currentTime = std::chrono::high_resolution_clock::now();
+  float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+
+  updateSpin(time);
+  updateTransforms();
+}
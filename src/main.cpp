@@ -2,12 +2,17 @@
 #include "Engine/Renderer/Vulkan/VulkanRenderer.h"
 #include "Engine/Renderer/Vulkan/VulkanDynamicBuffer.h"
 
-#include "Engine/Scene/Actor.h"
-#include "Engine/Scene/Node.h"
+#include "Engine/Scene/Camera.h"
 #include "Engine/Scene/Scene.h"
 
+#include "Engine/Jobs/FramePipeline.h"
+
+#include "Engine/Renderer/Vulkan/Resources/VulkanComputePipelineResourceFactory.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanMeshResourceFactory.h"
 #include "Engine/Renderer/Vulkan/Resources/VulkanPipelineResourceFactory.h"
+#include "Engine/Renderer/Vulkan/Resources/VulkanTextureResourceFactory.h"
+#include "Engine/Renderer/Vulkan/VulkanDefragmenter.h"
+#include "Engine/Resources/FileWatcher.h"
 #include "Engine/Resources/MockResourceFactory.h"
 #include "Engine/Resources/ResourceManager.h"
 
@@ -22,17 +27,29 @@ int main() {
   ResourceFactory *mockFactory = new MockResourceFactory();
   ResourceManager *resourceManager = ResourceManager::getInstance();
 
+  bool archiveMounted = resourceManager->mountArchive("assets.pak");
+  if (!archiveMounted) {
+    spdlog::info("no asset archive found, loading loose asset files");
+  }
+
   RendererParams params;
   params.x = 1920;
   params.y = 1080;
   VulkanRenderer vulkanRenderer = VulkanRenderer(params);
   vulkanRenderer.init();
 
+  // Variants recorded last run are rebuilt as soon as their pipeline loads
+  vulkanRenderer.getDevice()->getVariantLog()->load(PIPELINE_VARIANT_LOG_PATH);
+
   VulkanPipelineResourceFactory *vulkanPipelineFactory =
       new VulkanPipelineResourceFactory(vulkanRenderer.getDevice(), params,
-                                        vulkanRenderer.getRenderPass());
+                                        vulkanRenderer.getRenderPassKey());
   resourceManager->registerFactory(vulkanPipelineFactory);
 
+  VulkanComputePipelineResourceFactory *vulkanComputePipelineFactory =
+      new VulkanComputePipelineResourceFactory(vulkanRenderer.getDevice());
+  resourceManager->registerFactory(vulkanComputePipelineFactory);
+
   VulkanMeshResourceFactory *vulkanMeshFactory =
       new VulkanMeshResourceFactory(vulkanRenderer.getDevice());
   resourceManager->registerFactory(vulkanMeshFactory);
@@ -40,48 +57,95 @@ int main() {
   VulkanMeshInstanceResourceFactory *vulkanMeshInstanceFactory = new VulkanMeshInstanceResourceFactory(vulkanRenderer.getDevice());
   resourceManager->registerFactory(vulkanMeshInstanceFactory);
 
-  bool quit = false;
-  SDL_Event e;
-
-  std::shared_ptr<Resource> vulkanShaderResource =
-      resourceManager->getResource("assets/shaders/test_vk_resource.json");
-
-  std::shared_ptr<Resource> vulkanMeshResource =
-      resourceManager->getResource("assets/meshes/test_vk_mesh.json");
+  // Outlives the textures registered with it, like the factories
+  VulkanTextureStreamer *textureStreamer = new VulkanTextureStreamer(vulkanRenderer.getDevice());
 
-  std::shared_ptr<Resource> vulkanMeshInstanceResource = resourceManager->getResource("assets/meshes/test_vk_mesh_instance.json");
+  VulkanTextureResourceFactory *vulkanTextureFactory = new VulkanTextureResourceFactory(vulkanRenderer.getDevice(), textureStreamer);
+  resourceManager->registerFactory(vulkanTextureFactory);
 
-  std::shared_ptr<VulkanMeshInstanceResource> meshInstance = std::static_pointer_cast<VulkanMeshInstanceResource>(vulkanMeshInstanceResource);
+  bool quit = false;
+  SDL_Event e;
 
-  VulkanMeshRenderManager meshRenderManager = VulkanMeshRenderManager(vulkanRenderer.getDevice(), 100, vulkanRenderer.getFrameCount());
+  std::shared_ptr<VulkanMeshResource> vulkanMeshResource =
+      resourceManager->getResource(TEST_MESH_RESOURCE);
 
-  VulkanBuffer buffer = VulkanBuffer(vulkanRenderer.getDevice(), static_cast<uint32_t>(256 * 256 * 32), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+  ResourceHandle<VulkanMeshInstanceResource> meshInstance = resourceManager->acquire(TEST_MESH_INSTANCE_RESOURCE);
 
-  VulkanImage image = VulkanImage(vulkanRenderer.getDevice(), 256, 256, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+  VulkanMeshRenderManager meshRenderManager = VulkanMeshRenderManager(vulkanRenderer.getDevice(), vulkanRenderer.getAsyncCompute(), 100, vulkanRenderer.getFrameCount());
 
-  image.transferFromBuffer(&buffer);
+  Scene scene;
+  Entity actor = scene.createActor(meshInstance);
+  Spin spin;
+  spin.radiansPerSecond = glm::radians(90.0f);
+  scene.getRegistry().add<Spin>(actor, spin);
+  scene.setActiveCamera(scene.createCamera(params.x, params.y));
 
-  Actor* actor = new Actor(meshInstance);
-  Scene scene = Scene();
-  scene.addNode(actor);
+  // Written by the render stage, read by the simulation stage for the camera
+  std::atomic<uint32_t> extentWidth{params.x};
+  std::atomic<uint32_t> extentHeight{params.y};
 
-  while (!quit) {
+  FramePipeline framePipeline(FRAME_PIPELINE_DEPTH, [&](RenderSnapshot& snapshot) {
+    scene.getActiveCamera()->setExtent(extentWidth, extentHeight);
     scene.update();
-    std::vector<Node*> drawList = scene.getMeshDrawList();
-    // Render stuff
-    VulkanRenderFrame frame = vulkanRenderer.prepareFrame();
-    frame.begin();
-    meshRenderManager.draw(frame, drawList);
+    scene.buildSnapshot(snapshot);
+  });
+
+  // Loose asset files are watched so edited shaders are rebuilt in the
+  // background, packed archives never change while running
+  std::unique_ptr<FileWatcher> assetWatcher;
+  if (!archiveMounted) {
+    assetWatcher.reset(new FileWatcher("assets", [resourceManager](const std::vector<std::string>& files) {
+      resourceManager->reloadChanged(files);
+    }));
+  }
+
+  // Built once, a capturing lambda passed straight to renderFrame would be
+  // wrapped in a new heap allocated std::function every frame
+  std::function<void(const RenderSnapshot&)> renderStage = [&](const RenderSnapshot& snapshot) {
+    VulkanRenderFrame frame;
+    if (!vulkanRenderer.prepareFrame(frame)) {
+      return;
+    }
+    extentWidth = frame.extent.width;
+    extentHeight = frame.extent.height;
+    frame.beginCommands();
+    meshRenderManager.prepare(frame, snapshot);
+    frame.beginRenderPass();
+    meshRenderManager.draw(frame, snapshot);
     frame.end();
     vulkanRenderer.submitFrame(frame);
+  };
+
+  while (!quit) {
+    // Frame boundary, nothing is being recorded while resources are swapped
+    resourceManager->applyReloads();
+    resourceManager->collectRetired();
+    textureStreamer->update();
+    vulkanRenderer.getDevice()->getDefragmenter()->update();
+
+    // A minimized window has no extent to render to, frames are skipped but
+    // events are still handled so the app can be closed or restored
+    if (vulkanRenderer.isMinimized()) {
+      SDL_Delay(16);
+    } else {
+      framePipeline.renderFrame(renderStage);
+    }
 
-    // SDL input stuff
-    SDL_PollEvent(&e);
-    if (e.type == SDL_QUIT) {
-      quit = true;
+    // SDL input stuff, a drag produces many resize events per frame and
+    // the renderer folds them into one swapchain recreation
+    while (SDL_PollEvent(&e)) {
+      if (e.type == SDL_QUIT) {
+        quit = true;
+      } else if (e.type == SDL_WINDOWEVENT &&
+                 e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        vulkanRenderer.requestResize();
+      } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F12) {
+        vulkanRenderer.getDevice()->getMemoryStats()->writeSnapshot(GPU_MEMORY_STATS_PATH);
+      }
     }
   }
   vulkanRenderer.finishFrame();
+  vulkanRenderer.getDevice()->getVariantLog()->save(PIPELINE_VARIANT_LOG_PATH);
 
   return 0;
 }
\ No newline at end of file
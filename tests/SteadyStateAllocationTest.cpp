@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "Engine/Jobs/FramePipeline.h"
+#include "Engine/Scene/Scene.h"
+
+// Usage: SteadyStateAllocationTest [entities] [frames]
+// Runs Scene::update and Scene::buildSnapshot as the simulation stage of a
+// frame pipeline and fails if any frame after the warm-up allocates through
+// operator new. The actors hold no mesh instance, so no Vulkan device is
+// needed, and the render stage only reads the snapshot the way the culling
+// pass does. Scene jobs go to the default job system, which has no workers on
+// a single core machine.
+
+static const uint32_t WARMUP_FRAMES = 16;
+
+static std::atomic<uint64_t> allocationCount{0};
+
+void *operator new(size_t size) {
+  allocationCount++;
+  void *memory = std::malloc(size > 0 ? size : 1);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete[](void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+
+int main(int argc, char **argv) {
+  uint32_t entityCount = argc > 1 ? std::stoul(argv[1]) : 10000;
+  uint32_t frameCount = argc > 2 ? std::stoul(argv[2]) : 256;
+
+  Scene scene;
+  scene.setActiveCamera(scene.createCamera(1280, 720));
+
+  // Every actor spins, so every draw changes every frame
+  EntityRegistry &registry = scene.getRegistry();
+  for (uint32_t i = 0; i < entityCount; i++) {
+    Entity entity = scene.createActor(ResourceHandle<VulkanMeshInstanceResource>());
+    registry.get<Transform>(entity)->translation = glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100), 0.0f);
+
+    Spin spin;
+    spin.radiansPerSecond = 1.0f + static_cast<float>(i % 7);
+    registry.add<Spin>(entity, spin);
+  }
+
+  Scene *simulatedScene = &scene;
+  FramePipeline pipeline(2, [simulatedScene](RenderSnapshot &snapshot) {
+    simulatedScene->update();
+    simulatedScene->buildSnapshot(snapshot);
+  });
+
+  uint64_t changedDraws = 0;
+  std::function<void(const RenderSnapshot &)> renderStage = [&changedDraws](const RenderSnapshot &snapshot) {
+    for (uint32_t i = 0; i < snapshot.changedDrawCount; i++) {
+      const MeshDraw &draw = snapshot.meshDraws[snapshot.changedDraws[i]];
+      if (draw.model[3].w == 1.0f) {
+        changedDraws++;
+      }
+    }
+  };
+
+  for (uint32_t i = 0; i < WARMUP_FRAMES; i++) {
+    pipeline.renderFrame(renderStage);
+  }
+
+  changedDraws = 0;
+  uint64_t allocationsBefore = allocationCount;
+  for (uint32_t i = 0; i < frameCount; i++) {
+    pipeline.renderFrame(renderStage);
+  }
+  uint64_t allocations = allocationCount - allocationsBefore;
+
+  std::cout << entityCount << " entities, " << frameCount
+            << " frames after warm-up (" << changedDraws
+            << " changed draws): " << allocations << " heap allocations"
+            << std::endl;
+
+  if (allocations > 0) {
+    std::cout << "steady state frames allocated on the heap" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Engine/Resources/AssetArchive.h"
+
+// Usage: AssetPacker <asset directory> <output archive> [--no-compress]
+// Paths are stored relative to the working directory, matching the paths
+// resources are requested with, e.g. assets/meshes/test_vk_mesh.json
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: AssetPacker <asset directory> <output archive> "
+                 "[--no-compress]"
+              << std::endl;
+    return 1;
+  }
+
+  bool compress = !(argc > 3 && std::string(argv[3]) == "--no-compress");
+
+  std::vector<std::pair<std::string, std::vector<char>>> files;
+
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(argv[1])) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+
+    std::string path = entry.path().generic_string();
+    std::ifstream file(entry.path(), std::ios::binary | std::ios::ate);
+    std::vector<char> contents(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(contents.data(), contents.size());
+
+    files.push_back(std::make_pair(path, std::move(contents)));
+  }
+
+  std::sort(files.begin(), files.end());
+
+  if (!AssetArchive::write(argv[2], files, compress)) {
+    std::cerr << "failed to write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << "packed " << files.size() << " files into " << argv[2]
+            << std::endl;
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "Engine/Renderer/Vulkan/VulkanShaderReflection.h"
+
+// Usage: ShaderReflect <shader.spv> <output.json>
+// Writes the descriptor bindings, push constant block and vertex inputs the
+// engine derives its pipeline layouts from, for tooling and inspection
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: ShaderReflect <shader.spv> <output.json>"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream input(argv[1], std::ios::binary);
+  std::vector<char> code((std::istreambuf_iterator<char>(input)),
+                         std::istreambuf_iterator<char>());
+
+  ShaderReflection reflection;
+  if (!reflectShader(code, reflection)) {
+    std::cerr << "failed to reflect " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::ofstream output(argv[2]);
+  output << "{\n";
+  output << "    \"stage_flags\": " << reflection.stageFlags << ",\n";
+
+  output << "    \"bindings\": [";
+  for (int i = 0; i < reflection.bindings.size(); i++) {
+    const ShaderBinding &binding = reflection.bindings[i];
+    output << (i > 0 ? "," : "") << "\n        {\"set\": " << binding.set
+           << ", \"binding\": " << binding.binding
+           << ", \"descriptor_type\": " << binding.descriptorType
+           << ", \"descriptor_count\": " << binding.descriptorCount
+           << ", \"stage_flags\": " << binding.stageFlags << "}";
+  }
+  output << (reflection.bindings.empty() ? "" : "\n    ") << "],\n";
+
+  output << "    \"push_constants\": {\"size\": " << reflection.pushConstantSize
+         << ", \"stage_flags\": " << reflection.pushConstantStages << "},\n";
+
+  output << "    \"inputs\": [";
+  for (int i = 0; i < reflection.inputs.size(); i++) {
+    output << (i > 0 ? "," : "")
+           << "\n        {\"location\": " << reflection.inputs[i].location
+           << ", \"format\": " << reflection.inputs[i].format << "}";
+  }
+  output << (reflection.inputs.empty() ? "" : "\n    ") << "]\n";
+  output << "}\n";
+
+  if (!output) {
+    std::cerr << "failed to write " << argv[2] << std::endl;
+    return 1;
+  }
+  return 0;
+}